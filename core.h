@@ -0,0 +1,1918 @@
+/* the part of the simulator that depends on the width of simtime.
+   scheduling.c includes this twice, with TIME_BITS set to 32 and
+   then to 64. CORE appends the width to every name defined here so
+   the two copies don't clash, e.g. runInput becomes runInput32 and
+   runInput64. anything new defined at file scope in here needs a
+   line in the list below */
+
+#define CORE(name) CORE_PASTE(name, TIME_BITS)
+#define CORE_PASTE(name, bits) CORE_PASTE2(name, bits)
+#define CORE_PASTE2(name, bits) name ## bits
+
+#define simtime CORE(simtime)
+#define process CORE(process)
+#define summary CORE(summary)
+#define partition CORE(partition)
+#define stepFn CORE(stepFn)
+#define replicaJob CORE(replicaJob)
+#define spinBarrier CORE(spinBarrier)
+#define workers CORE(workers)
+#define barrierSense CORE(barrierSense)
+#define batch CORE(batch)
+#define printProcess CORE(printProcess)
+#define printProcessSummary CORE(printProcessSummary)
+#define printState CORE(printState)
+#define computeSummary CORE(computeSummary)
+#define printFinalSummary CORE(printFinalSummary)
+#define printStats CORE(printStats)
+#define schedulerName CORE(schedulerName)
+#define printResults CORE(printResults)
+#define printQ CORE(printQ)
+#define printT CORE(printT)
+#define createProcess CORE(createProcess)
+#define sortProcByArrival CORE(sortProcByArrival)
+#define readFile CORE(readFile)
+#define enqueue CORE(enqueue)
+#define dequeue CORE(dequeue)
+#define qIsEmpty CORE(qIsEmpty)
+#define QSize CORE(QSize)
+#define clearArr CORE(clearArr)
+#define zeroArr CORE(zeroArr)
+#define lessThan CORE(lessThan)
+#define checkedAdd CORE(checkedAdd)
+#define maxRuntime CORE(maxRuntime)
+#define newPtoTemp CORE(newPtoTemp)
+#define arrivalsRange CORE(arrivalsRange)
+#define arrivalsAndBlocked CORE(arrivalsAndBlocked)
+#define tempToReady CORE(tempToReady)
+#define updateQ CORE(updateQ)
+#define updateRun CORE(updateRun)
+#define runRange CORE(runRange)
+#define somethingRunning CORE(somethingRunning)
+#define moveProcToRunning CORE(moveProcToRunning)
+#define updateBlocked CORE(updateBlocked)
+#define blockedRange CORE(blockedRange)
+#define tieBreak CORE(tieBreak)
+#define sortQSJF CORE(sortQSJF)
+#define allDone CORE(allDone)
+#define cpuBurst CORE(cpuBurst)
+#define ioBurst CORE(ioBurst)
+#define nextTraceValue CORE(nextTraceValue)
+#define loadTrace CORE(loadTrace)
+#define randomOS CORE(randomOS)
+#define FCFS CORE(FCFS)
+#define FCFSstep CORE(FCFSstep)
+#define uniprogrammed CORE(uniprogrammed)
+#define RR CORE(RR)
+#define RRstep CORE(RRstep)
+#define SJF CORE(SJF)
+#define SJFstep CORE(SJFstep)
+#define runUntil CORE(runUntil)
+#define runScheduler CORE(runScheduler)
+#define runInput CORE(runInput)
+#define switchScheduler CORE(switchScheduler)
+#define forkContinuations CORE(forkContinuations)
+#define elapsedMs CORE(elapsedMs)
+#define replicaWorker CORE(replicaWorker)
+#define tCritical CORE(tCritical)
+#define printInterval CORE(printInterval)
+#define runReplicas CORE(runReplicas)
+#define barrierWait CORE(barrierWait)
+#define runPass CORE(runPass)
+#define workerLoop CORE(workerLoop)
+#define startWorkers CORE(startWorkers)
+#define stopWorkers CORE(stopWorkers)
+#define parallelPass CORE(parallelPass)
+#define startWindows CORE(startWindows)
+#define writeWindow CORE(writeWindow)
+#define windowTick CORE(windowTick)
+#define windowFlush CORE(windowFlush)
+#define printJSONString CORE(printJSONString)
+#define printCSVString CORE(printCSVString)
+#define printBatchRun CORE(printBatchRun)
+#define batchFile CORE(batchFile)
+#define freeBatch CORE(freeBatch)
+
+/*  ================== time ================= */
+
+#if TIME_BITS == 64
+typedef long long simtime;
+#define SIMTIME_MAX LLONG_MAX
+#define PRItime "lld"
+#else
+typedef int simtime;
+#define SIMTIME_MAX INT_MAX
+#define PRItime "d"
+#endif
+
+/*  ================== process struct ================= */
+
+typedef struct {
+	int A; /* arrival time */
+	int B; /* burst time */
+	int C; /* total CPU time */
+	int IO; /* IO burst time */
+    int pid; /* process id number (based on loc in input file) */
+	simtime waitTime; /* time in ready state */
+	simtime IOtime; /* time in blocked state */
+	simtime finishTime; /* finishing time */
+	int state; /* -1:unstarted, 0:ready, 1:running, 2:blocked, 3:finished */
+	int blockedTimer; /* time remaining in blocked state */
+	int runningTimer; /* time remaining in running state */
+    int CPUleft; /* how much time left until finished */
+    simtime timeIntoRQ; /* time when last got placed in ready Q */
+    int justBlocked; /* flag whether or not JUST got out of blocked state */
+    int Qtimer; /* for RR, current quantum timer */
+    const char *trace; /* next unread burst in the trace, NULL when not replaying */
+    const char *traceEnd; /* end of this process's line of the trace */
+} process;
+
+/*  ================== summary struct ================= */
+
+typedef struct {
+    simtime finish; /* finishing time */
+    double cpuU; /* CPU utilization */
+    double ioU; /* I/O utilization */
+    double thru; /* processes per hundred cycles */
+    double avgTurn; /* average turnaround time */
+    double avgWait; /* average waiting time */
+} summary;
+
+/*  ================== partition struct ================= */
+
+typedef struct {
+    int lo; /* first process in this slice of the table */
+    int hi; /* one past the last process */
+    int *list; /* pids collected by a pass, in table order */
+    int n; /* length of list */
+    int *draws; /* processes needing a blocked timer, NULL to draw right away */
+    int nDraws; /* length of draws */
+    int busy; /* saw a blocked process */
+    int cpu; /* running processes that got a cycle */
+    int finished; /* processes that finished this cycle */
+    int *arrived; /* pids arriving this cycle, in table order */
+    int nArrived; /* length of arrived */
+    int stopped; /* running processes that finished or blocked */
+} partition;
+
+/* ================= helper functions declarations ================= */
+
+int randomOS(int U, int CPUleft);
+int cpuBurst(process *p);
+int ioBurst(process *p);
+int nextTraceValue(process *p);
+void loadTrace(process processes[], traceMap *trace);
+int getBurstTime();
+void printProcess(process p);
+void printProcessSummary(process p);
+void printState(process processes[], simtime currTime);
+void printFinalSummary(process processes[]);
+summary computeSummary(process processes[]);
+void printResults(process processes[], char scheduler);
+const char *schedulerName(char scheduler);
+void printQ(int *q);
+void printT(int *q);
+void enqueue(int *q, int p);
+int dequeue(int *q);
+int qIsEmpty(int *q);
+void sortQSJF(int *temp, int n, process processes[]);
+int QSize(int *q);
+int newPtoTemp(process processes[], simtime currTime, int *temp);
+void tempToReady(int *temp, int *q, int c, simtime currTime, process processes[]);
+process createProcess(int a, int b, int c, int io, int id );
+void sortProcByArrival(process processes[]);
+void readFile(FILE *file, process processes[]);
+void tieBreak(int *temp, int n, process processes[]);
+int updateBlocked(process processes[], int *temp, int c);
+int updateRun(process processes[], simtime currTime, int *temp, int c);
+int somethingRunning(process processes[]);
+void updateQ(process processes[], int *q, simtime currTime, int *temp, int c);
+void moveProcToRunning(process processes[], int *q, simtime currTime);
+int allDone(process processes[]);
+void zeroArr(int *arr);
+void clearArr(int *arr, int n);
+int arrivalsAndBlocked(process processes[], simtime currTime, int *temp);
+void arrivalsRange(process processes[], simtime currTime, partition *part);
+void blockedRange(process processes[], partition *part);
+void runRange(process processes[], simtime currTime, int q, partition *part);
+
+/* ================= schedulers ================= */
+
+void FCFS(process processes[], int *readyQ, int *temp);
+void uniprogrammed(process processes[], int *readyQ, int *temp);
+void RR( process processes[], int *readyQ, int *temp );
+void SJF( process processes[], int *readyQ, int *temp );
+
+/* one cycle of a tick-loop scheduler, starting at currTime */
+typedef void (*stepFn)(process processes[], int *readyQ, int *temp, simtime currTime);
+
+void FCFSstep(process processes[], int *readyQ, int *temp, simtime currTime);
+void RRstep(process processes[], int *readyQ, int *temp, simtime currTime);
+void SJFstep(process processes[], int *readyQ, int *temp, simtime currTime);
+simtime runUntil(stepFn step, process processes[], int *readyQ, int *temp, simtime currTime, long long stopTime);
+stepFn switchScheduler(char scheduler, int quantum, process processes[]);
+int forkContinuations(process processes[], int *readyQ, int *temp, simtime currTime, char *variants);
+int runScheduler(char scheduler, process processes[], int *readyQ, int *temp);
+void runReplicas(process processes[], char scheduler, int k);
+void startWorkers(int n);
+void stopWorkers();
+int parallelPass(int pass, process processes[], simtime currTime, int *temp, int c);
+void startWindows(const char *path);
+void windowTick(process processes[], int *readyQ, simtime currTime);
+void windowFlush(process processes[], int *readyQ);
+int runInput(char *args[], long long forkAt, char *variants, int replicas, traceMap *trace, const char *windowFile);
+int batchFile(const char *path, char scheduler, int csv);
+void freeBatch();
+int lessThan(int a, int b);
+long long checkedAdd(long long a, long long b);
+long long maxRuntime(process processes[], traceMap *trace);
+void printStats(char scheduler);
+
+
+/* ================= helper functions declarations ================= */
+
+void printProcess(process p) {
+
+    printf("process id: %d\n", p.pid);
+    printf("arrival time: %d\n", p.A);
+    printf("burst time: %d\n", p.B);
+    printf("total cpu time: %d\n", p.C);
+    printf("io burst time: %d\n", p.IO);
+    printf("current state: %d\n", p.state);
+    printf("time left in blocked state: %d\n", p.blockedTimer);
+    printf("time left in running state: %d\n", p.runningTimer);
+    printf("CPU time left: %d\n", p.CPUleft);
+    printf("total time in ready state so far: %" PRItime "\n", p.waitTime);
+    printf("total time in blocked state so far: %" PRItime "\n", p.IOtime);
+    printf("finish time: %" PRItime "\n", p.finishTime);
+}
+
+void printProcessSummary(process p) {
+    printf("\t(A,B,C,IO) = (%d,%d,%d,%d)\n", p.A, p.B, p.C, p.IO);
+    printf("\tFinishing time: %" PRItime "\n", p.finishTime);
+    printf("\tTurnaround time: %" PRItime "\n", (p.finishTime - p.A));
+    printf("\tI/O time: %" PRItime "\n", p.IOtime);
+    printf("\tWaiting time: %" PRItime "\n", p.waitTime);
+}
+
+void printState(process processes[], simtime currTime) {
+    printf("Before cycle %5" PRItime ": ", currTime);
+    for(int i = 0; i < numProcs; i++) {
+        if(processes[i].state == -1) {
+            printf("%15s %3d ", "unstarted", 0);
+        }
+        else if(processes[i].state == 0) {
+            printf("%15s %3d ","ready", 0);
+        }
+        else if(processes[i].state == 1) {
+            printf("%15s %3d ", "running", processes[i].runningTimer);
+        }
+        else if(processes[i].state == 2) {
+            printf("%15s %3d ", "blocked", processes[i].blockedTimer);
+        }
+        else {
+            printf("%15s %3d ", "finished", 0);
+        }
+    }
+    printf("\n");
+}
+
+summary computeSummary(process processes[]) {
+
+    summary s;
+    s.finish = finalFinish;
+    s.cpuU = (double) totCPU / (double) finalFinish;
+    s.ioU = (double) totIO / (double) finalFinish;
+
+    long long turn = 0;
+    long long wait = 0;
+    for(int i = 0; i < numProcs; i++) {
+        turn = checkedAdd(turn, processes[i].finishTime - processes[i].A);
+        wait = checkedAdd(wait, processes[i].waitTime);
+    }
+
+    s.avgTurn = (double)turn / (double) numProcs;
+    s.avgWait = (double) wait / (double) numProcs;
+    s.thru = 100 / ((double)(finalFinish) / (double) numProcs);
+
+    return s;
+}
+
+void printFinalSummary(process processes[]) {
+
+    summary s = computeSummary(processes);
+
+    printf("Summary Data: \n");
+    printf("\tFinishing Time: %" PRItime "\n", s.finish);
+    printf("\tCPU Utilization: %f\n", s.cpuU);
+    printf("\tI/O Utilization: %f\n", s.ioU);
+    printf("\tThroughput: %f processes per hundred cycles\n", s.thru);
+    printf("\tAverage turnaround Time: %f\n", s.avgTurn);
+    printf("\tAverage waiting Time: %f\n", s.avgWait);
+}
+
+void printStats(char scheduler) {
+
+    /* one line of JSON on stderr so it stays out of the way
+       of the normal output. with --threads arrivals are only ever
+       timed along with updateBlocked, as arrivalsAndBlocked, and
+       without they never are, so each mode leaves the other out */
+    static const char *phaseNames[NUM_PHASES] = {
+        "newPtoTemp", "updateBlocked", "tempToReady", "sortQSJF", "updateRun", "moveProcToRunning",
+        "arrivalsAndBlocked"
+    };
+    int skip = (numWorkers > 1) ? PHASE_ARRIVALS : PHASE_ARRIVALS_BLOCKED;
+
+    fprintf(stderr, "{\"scheduler\":\"%c\",\"processes\":%d,\"cycles\":%lld,\"threads\":%d,\"timer\":\"%s\",\"phases\":{",
+        scheduler, numProcs, finalFinish, numWorkers, TIMER_NAME);
+    int first = 1;
+    for(int i = 0; i < NUM_PHASES; i++) {
+        if(i == skip) {
+            continue;
+        }
+        fprintf(stderr, "%s\"%s\":{\"calls\":%llu,\"ticks\":%llu}", first ? "" : ",",
+            phaseNames[i], phases[i].calls, phases[i].ticks);
+        first = 0;
+    }
+    fprintf(stderr, "},\"counters\":{\"enqueues\":%llu,\"dequeues\":%llu,\"comparisons\":%llu,"
+        "\"randomDraws\":%llu,\"traceReads\":%llu,\"toReady\":%llu,\"toRunning\":%llu,"
+        "\"toBlocked\":%llu,\"toFinished\":%llu}}\n",
+        counters.enqueues, counters.dequeues, counters.comparisons, counters.randomDraws,
+        counters.traceReads, counters.toReady, counters.toRunning, counters.toBlocked,
+        counters.toFinished);
+}
+
+const char *schedulerName(char scheduler) {
+    switch(scheduler) {
+        case('f'): return "FCFS";
+        case('u'): return "uniprogrammed";
+        case('r'): return "Round Robin";
+        case('s'): return "Shortest Job First";
+        default: return "unknown";
+    }
+}
+
+void printResults(process processes[], char scheduler) {
+    printf("\nThe scheduling process used was %s\n", schedulerName(scheduler));
+
+    /* print process summaries */
+    printf("\n");
+    for(int i = 0; i < numProcs; i++) {
+        printf("Process %d:\n", i);
+        printProcessSummary(processes[i]);
+        printf("\n");
+    }
+
+    printFinalSummary(processes);
+}
+
+void printQ(int *q) {
+    printf("Ready Queue");
+    for (int i = 0; i < numProcs; i++) {
+        printf(" : %d", q[i]);
+    }
+    printf("\n");
+}
+
+void printT(int *q) {
+    printf("Temp Array");
+    for (int i = 0; i < numProcs; i++) {
+        printf(" : %d", q[i]);
+    }
+    printf("\n");
+}
+
+process createProcess(int a, int b, int c, int io, int id ) {
+    process newProcess = {
+        a,
+        b,
+        c,
+        io,
+        id,
+        0,
+        0,
+        0,
+        -1,
+        0,
+        0,
+        c,
+        0,
+        0,
+        0,
+        NULL,
+        NULL
+    };
+
+    return newProcess;        
+}
+
+void sortProcByArrival(process processes[]) {
+    int c,d;
+    process t;
+    int n = numProcs;
+
+    for (c = 1 ; c <= n - 1; c++) {
+        d = c;
+     
+        while ( d > 0 && processes[d].A < processes[d-1].A) {
+          t = processes[d];
+          processes[d] = processes[d-1];
+          processes[d-1] = t;
+          d--;
+        }
+    }
+
+    for(int i = 0; i < numProcs; i++) {
+        processes[i].pid = i;
+    }
+}
+
+void enqueue(int *q, int p) {
+    //place a process at back of array
+	//printf("*****ENQUEUEING NOW!*****\n");
+    STAT_COUNT(enqueues, 1);
+    q[qLen++] = p;
+}
+
+int dequeue(int *q) {
+    //remove first item from array and shift all others up
+
+    //printf("*****DEQUEUEING NOW!*****\n");
+    STAT_COUNT(dequeues, 1);
+
+    int pid = q[0]; //if array is empty, q[0] = -1 which is good
+    
+    //shift all elements up. the queue is always packed at the
+    //front, so only the first qLen slots need to move
+    if(qLen > 0) {
+        memmove(q, q + 1, (qLen - 1) * sizeof(int));
+        q[--qLen] = -1; //to preserve integrity of queue 
+    }
+
+    return pid;
+}
+
+int qIsEmpty(int *q) {
+    //there's only ever one ready queue per simulation, see qLen
+    (void) q;
+    return qLen == 0;
+}
+
+int newPtoTemp(process processes[], simtime currTime, int *temp) {
+    //puts processes created at currTime in temp array
+    //returns number of processes just added
+    STAT_START(t);
+    partition part = {0, numProcs, NULL, 0, NULL, 0, 0, 0, 0, temp, 0, 0};
+    arrivalsRange(processes, currTime, &part);
+    STAT_STOP(PHASE_ARRIVALS, t);
+    return part.nArrived;
+}
+
+void arrivalsRange(process processes[], simtime currTime, partition *part) {
+    for(int i = part->lo; i < part->hi; i++) {
+        if(processes[i].A == currTime) {
+            part->arrived[part->nArrived] = processes[i].pid;
+            part->nArrived++;
+        }
+    }
+}
+
+int arrivalsAndBlocked(process processes[], simtime currTime, int *temp) {
+    //puts processes created at currTime and then newly unblocked ones
+    //in temp array, returns how many. neither pass looks at what the
+    //other changes, so with --threads they share one round of the
+    //workers, timed as a phase of its own
+    if(numWorkers > 1) {
+        STAT_START(t);
+        int c = parallelPass(PASS_ARRIVALS_BLOCKED, processes, currTime, temp, 0);
+        STAT_STOP(PHASE_ARRIVALS_BLOCKED, t);
+        return c;
+    }
+    int c = newPtoTemp(processes, currTime, temp);
+    return updateBlocked(processes, temp, c);
+}
+
+void tempToReady(int *temp, int *q, int c, simtime currTime, process processes[]) {
+    //moves all c process from temp array to readyQ with ties taken care of
+    //sets these processes arrival to Q time as current time
+    STAT_START(t);
+    tieBreak(temp,c,processes);
+    
+    for(int i = 0; i < c; i++) {
+        enqueue(q, temp[i]);
+        if(processes[temp[i]].state == 1) {
+            totRunning--; //preempted
+        }
+        processes[temp[i]].timeIntoRQ = currTime;
+        processes[temp[i]].state = 0;
+    }
+    STAT_COUNT(toReady, c);
+    STAT_STOP(PHASE_READY, t);
+}
+
+void updateQ(process processes[], int *q, simtime currTime, int *temp, int c) {
+
+	//printf("***** UPDATING QUEUE NOW!*****\n");
+    // increments wait counter for all processes that are in ready Q
+    // adds elements that have just arrived to temporary buffer
+    for(int i = 0; i < numProcs; i++) {
+        //check if in ready state
+        if(processes[i].state == 0) {
+            processes[i].waitTime += 1;
+        }
+        if(processes[i].state == -1 && processes[i].A == currTime) {
+            //put these in temporary buffer
+            temp[c] = processes[i].pid;
+            c++;
+        }
+        //at this point we should have all the elements
+        //that may need to get into the actual ready q in 
+        //the temp buffer. add them in proper order (tie 
+        //breakers) to readyQ 
+        if(c > 0) {
+            tieBreak(temp, c, processes);
+            for(int i = 0; i < c; i++) {
+                enqueue(q, temp[i]);
+            }
+        } 
+    }
+}
+
+int updateRun(process processes[], simtime currTime , int *temp, int c) {
+
+    /* this function decrements the current running timer for the
+       running process. if the timer reaches 0, state moves to 
+       finished with finish time = curr time. otherwise moves to 
+       blocked or gets preempted
+    */
+
+    // returns c plus the number of preempted processes added to temp
+    STAT_START(t);
+    if(numWorkers > 1) {
+        c = parallelPass(PASS_RUN, processes, currTime, temp, c);
+    }
+    else {
+        partition part = {0, numProcs, temp + c, 0, NULL, 0, 0, 0, 0, NULL, 0, 0};
+        runRange(processes, currTime, Q, &part);
+        totCPU += part.cpu;
+        if(part.finished) { finalFinish = currTime; }
+        totFinished += part.finished;
+        totRunning -= part.stopped;
+        STAT_COUNT(toFinished, part.finished);
+        c += part.n;
+    }
+    STAT_STOP(PHASE_RUN, t);
+    return c;
+}
+
+void runRange(process processes[], simtime currTime, int q, partition *part) {
+    for(int i = part->lo; i < part->hi; i++) {
+        //check if in running state
+        if(processes[i].state == 1 && !(processes[i].justBlocked)) {
+            part->cpu += 1;
+            processes[i].runningTimer -= 1;
+            processes[i].CPUleft -= 1;
+            processes[i].Qtimer -= 1;
+
+            //if this causes their timer to end,
+            //check if need to move to blocked state with new blockedTimer
+            //or to finished state
+            if(processes[i].CPUleft == 0) { //terminated
+                processes[i].state = 3;
+                processes[i].finishTime = currTime;
+                part->finished += 1;
+                part->stopped += 1;
+            }
+            else if(processes[i].runningTimer == 0) { //block
+                processes[i].state = 2;
+                part->stopped += 1;
+                //worker threads leave the draw to the merge so the
+                //random numbers get used in the same order
+                if(part->draws == NULL) {
+                    processes[i].blockedTimer = ioBurst(&processes[i]);
+                }
+                else {
+                    part->draws[part->nDraws] = i;
+                    part->nDraws++;
+                }
+            }
+
+            else if(q > 0 && processes[i].Qtimer == 0) {
+                part->list[part->n] = processes[i].pid;
+                part->n++;
+            }
+        }
+        else if(processes[i].justBlocked == 1) {
+            processes[i].justBlocked = 0;
+        }
+    }
+}
+
+int somethingRunning(process processes[]) {
+
+	//printf("***** CHECKING IF SOMETHING IS RUNNING NOW!*****\n");
+    //return 1 if something is running, otherwise 0. every move
+    //in or out of the running state updates totRunning
+    (void) processes;
+    return totRunning > 0;
+}
+
+void moveProcToRunning(process processes[], int *q, simtime currTime) {
+    //need to move first process off queue to running state
+    //calculate how long it's been in Q this time and add to
+    //total running wait time in Q
+    STAT_START(t);
+    int p = dequeue(q);
+    processes[p].state = 1;
+    totRunning++;
+    if(processes[p].runningTimer == 0) {
+        processes[p].runningTimer = cpuBurst(&processes[p]);
+    }
+    //processes[p].runningTimer = randomOS(randomNums, processes[p].B, processes[p].CPUleft);
+    //printf("difference is: %d\n", (currTime - processes[p].timeIntoRQ) );
+    processes[p].waitTime += (currTime - processes[p].timeIntoRQ);
+    if(Q > 0) {
+        processes[p].Qtimer = Q;
+    }
+    STAT_COUNT(toRunning, 1);
+    STAT_STOP(PHASE_DISPATCH, t);
+}
+
+int updateBlocked(process processes[], int *temp, int c) {
+
+    //add processes that have finished blocking to temp array
+    STAT_START(t);
+    if(numWorkers > 1) {
+        c = parallelPass(PASS_BLOCKED, processes, 0, temp, c);
+    }
+    else {
+        partition part = {0, numProcs, temp + c, 0, NULL, 0, 0, 0, 0, NULL, 0, 0};
+        blockedRange(processes, &part);
+        if (part.busy) { totIO += 1; }
+        c += part.n;
+    }
+    STAT_STOP(PHASE_BLOCKED, t);
+    return c;
+}
+
+void blockedRange(process processes[], partition *part) {
+    for(int i = part->lo; i < part->hi; i++) {
+        //check if in blocked state
+        if(processes[i].state == 2) {
+            part->busy = 1;
+            processes[i].blockedTimer -= 1;
+            processes[i].IOtime += 1;
+            //if this causes their timer to end add to temp array
+            if(processes[i].blockedTimer == 0) {
+                part->list[part->n] = processes[i].pid;
+                part->n++;
+                processes[i].justBlocked = 1;
+            }
+        } 
+    }
+}
+
+void tieBreak(int *temp, int n, process processes[]) {
+
+    //use insertion sort twice to sort the elements in 
+    //the temp array to be placed in the readyQ. first 
+    //sort by arrival time and then by pid. since insertion
+    //sort is stable, this will correctly break all ties
+    //n is number of elements in temp array
+
+    int c,d,t;
+
+    for (c = 1 ; c <= n - 1; c++) {
+        d = c;
+     
+        while ( d > 0 && lessThan(processes[temp[d]].A, processes[temp[d-1]].A)) {
+          t = temp[d];
+          temp[d] = temp[d-1];
+          temp[d-1] = t;
+          d--;
+        }
+    }
+
+    for (c = 1 ; c <= n - 1; c++) {
+        d = c;
+     
+        while ( d > 0 && lessThan(processes[temp[d]].pid, processes[temp[d-1]].pid)) {
+          t = temp[d];
+          temp[d] = temp[d-1];
+          temp[d-1] = t;
+          d--;
+        }
+    } 
+}
+
+void sortQSJF(int *temp, int n, process processes[]) {
+    int c,d,t;
+    STAT_START(timer);
+
+    for (c = 1 ; c <= n - 1; c++) {
+        d = c;
+     
+        while ( d > 0 && lessThan(processes[temp[d]].CPUleft, processes[temp[d-1]].CPUleft)) {
+          t = temp[d];
+          temp[d] = temp[d-1];
+          temp[d-1] = t;
+          d--;
+        }
+    } 
+    STAT_STOP(PHASE_SORT, timer);
+}
+
+int lessThan(int a, int b) {
+    //comparison used by the hot path sorts, so they can be counted
+    STAT_COUNT(comparisons, 1);
+    return a < b;
+}
+
+int QSize(int *q) {
+    //there's only ever one ready queue per simulation, see qLen
+    (void) q;
+    return qLen;
+}
+
+int allDone(process processes[]) {
+    //return 0 when at least one process not finished, 1 otherwise.
+    //every finish goes through updateRun, which counts them
+    (void) processes;
+    return totFinished == numProcs;
+}
+
+long long checkedAdd(long long a, long long b) {
+    //sum for totals that could get past 64 bits on huge runs
+    long long sum;
+    if(__builtin_add_overflow(a, b, &sum)) {
+        printf("Overflow adding up totals. Exiting.\n");
+        exit(1);
+    }
+    return sum;
+}
+
+long long maxRuntime(process processes[], traceMap *trace) {
+
+    /* every cycle either runs a process, has one blocked, or waits
+       for the next arrival, and a process blocks at most once per
+       unit of CPU time, for IO cycles or a burst off its trace, so
+       the run can't go past the last arrival plus every C*(1+IO)
+       plus every traced burst. if that fits in simtime so do
+       finishing, waiting and I/O times and the totals built from
+       them. trace is NULL when not replaying one. -1 if the bound
+       itself doesn't fit in 64 bits */
+    long long bound = 0;
+    int overflow = 0;
+    for(int i = 0; i < numProcs; i++) {
+        long long work;
+        overflow |= __builtin_mul_overflow((long long) processes[i].C, 1LL + processes[i].IO, &work);
+        overflow |= __builtin_add_overflow(bound, work, &bound);
+        if(trace != NULL && i < trace->lines) {
+            overflow |= __builtin_add_overflow(bound, trace->total[i], &bound);
+        }
+    }
+    if(numProcs > 0) {
+        overflow |= __builtin_add_overflow(bound, (long long) processes[numProcs-1].A + 1, &bound);
+    }
+    return overflow ? -1 : bound;
+}
+
+void clearArr(int *arr, int n) {
+    //like zeroArr for just the first n slots
+    for(int i = 0; i < n; i++) {
+        arr[i] = -1;
+    }
+}
+
+void zeroArr(int *arr) {
+    for(int i = 0; i < numProcs; i++) {
+        arr[i] = -1;
+    }
+}
+
+void readFile(FILE *file, process processes[]) {
+    
+    char paren1;
+    int a;
+    int b;
+    int c;
+    int io;
+    char paren2;
+
+    for(int i = 0; i < numProcs; i++) {
+        fscanf(file, " %c %d %d %d %d %c", &paren1, &a, &b, &c, &io, &paren2);
+        process newP = createProcess(a,b,c,io,i);
+        processes[i] = newP;
+    }
+}
+
+int cpuBurst(process *p) {
+
+    /* next CPU burst for p, from its trace when replaying one
+       and randomOS otherwise. never more than the CPU time left */
+    int b = nextTraceValue(p);
+    if(b < 0) {
+        return randomOS(p->B, p->CPUleft);
+    }
+    if(b < 1) b = 1;
+    return (b < p->CPUleft) ? b : p->CPUleft;
+}
+
+int ioBurst(process *p) {
+    //only ever called as p goes from running to blocked
+    STAT_COUNT(toBlocked, 1);
+    int b = nextTraceValue(p);
+    if(b < 0) {
+        return randomOS(p->IO, p->IO);
+    }
+    return (b < 1) ? 1 : b;
+}
+
+int nextTraceValue(process *p) {
+
+    /* parses the next burst length off p's line of the trace.
+       returns -1 once the line is used up, after which p goes
+       back to randomOS for the rest of the run */
+    if(p->trace == NULL) {
+        return -1;
+    }
+
+    long long v = parseTraceValue(&p->trace, p->traceEnd);
+    if(v < 0) {
+        p->trace = NULL;
+        return -1;
+    }
+    STAT_COUNT(traceReads, 1);
+    return (int) v;
+}
+
+void loadTrace(process processes[], traceMap *trace) {
+    //points every process at its line of the trace, see mapTrace
+    for(int i = 0; i < numProcs && i < trace->lines; i++) {
+        processes[i].trace = trace->start[i];
+        processes[i].traceEnd = trace->end[i];
+    }
+}
+
+int randomOS(int U, int CPUleft) {
+
+    /* grabs next random number, 
+        mods it with burst time and adds 1.
+        if it's greater than cpu left returns cpu left */
+	int r = randomNums[rngCursor];
+    STAT_COUNT(randomDraws, 1);
+    rngDraws++;
+
+    rngCursor = (rngCursor + 1) % numRandom;
+   
+    r = 1 + (r % U);
+
+    if (r < CPUleft) {
+    	return r;
+    }
+    else {
+    	return CPUleft;
+    }
+} 
+
+
+
+/* ============= INDIVIDUAL SCHEDULERS ================ */
+
+void FCFS(process processes[], int *readyQ, int *temp) {
+
+    /* 
+        FCFS algorithm. Continues so long as some processes still running.
+        Not preemptive. global vars keep track of system usage. 
+    */
+    runUntil(FCFSstep, processes, readyQ, temp, 0, -1);
+}
+
+void FCFSstep(process processes[], int *readyQ, int *temp, simtime currTime) {
+    int c = 0;
+
+    if(verbose) {
+        printState(processes, currTime);
+    }  
+
+    //put all newly created processes in temp array, then
+    //update all blocked and put newly unblocked processes there too
+    c = arrivalsAndBlocked(processes, currTime, temp);
+
+    //put all processes from temp array onto readyQ
+    tempToReady(temp, readyQ, c, currTime, processes);
+
+    c = updateRun(processes, currTime, temp, c);
+
+    //if nothing is running and our queue isn't empty, 
+    //put first proc from readyQ in running position
+    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
+        moveProcToRunning(processes, readyQ, currTime);
+    }
+
+    //only the first c slots of temp got used
+    clearArr(temp, c);
+}
+
+void uniprogrammed(process processes[], int *readyQ, int *temp) {
+    simtime currTime = 0;
+    int c = 0;
+
+    if(verbose) {
+        printState(processes, currTime);
+    }    
+
+    /* put all processes on readyQ in their correct order */
+    for(int i = 0; i < numProcs; i++) {
+        if(processes[i].A == 0) {
+            enqueue(readyQ, processes[i].pid); 
+            processes[i].state = 0;
+            STAT_COUNT(toReady, 1);
+            processes[i].timeIntoRQ = 0;
+            //printf("processes[%d].timeIntoRQ = %d\n", i, processes[i].timeIntoRQ);
+        }
+    }
+
+    /* set when the burst moveProcToRunning gives process 0 came
+       from its trace. the loop below draws process 0 a fresh burst,
+       which only wastes a random number but would skip a recorded one */
+    int tracedStart = 0;
+
+    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
+        int first = readyQ[0];
+        int hadTrace = (processes[first].trace != NULL);
+        moveProcToRunning(processes, readyQ, currTime);
+        tracedStart = (first == 0 && hadTrace && processes[first].trace != NULL);
+    }
+
+    if(window.size > 0) {
+        windowTick(processes, readyQ, currTime);
+    }
+
+    currTime++;
+    c = 0;
+    zeroArr(temp);
+
+    int currProc = 0;
+
+    while (currProc < numProcs) {
+        if(processes[currProc].state != 1) {
+            totRunning++;
+        }
+        processes[currProc].state = 1;
+        STAT_COUNT(toRunning, 1);
+        processes[currProc].waitTime += (currTime - processes[currProc].timeIntoRQ - 1);
+        if(!(currProc == 0 && tracedStart)) {
+            processes[currProc].runningTimer = cpuBurst(&processes[currProc]);
+        }
+        //readyQ only holds processes that arrived and haven't started,
+        //in pid order, so if this one arrived it's at the front
+        if(readyQ[0] == processes[currProc].pid) {
+            dequeue(readyQ);
+        }
+        while(processes[currProc].state != 3) {
+
+            if(verbose) {
+                printState(processes, currTime);
+            }
+
+            c = updateBlocked(processes, temp, c);
+            if(c > 0) {
+                //if it got unblocked, put it in my temporary RQ
+                processes[currProc].state = 0;
+                STAT_COUNT(toReady, 1);
+            }
+            updateRun(processes, currTime, temp, c);
+
+            if(processes[currProc].state == 0) {
+                processes[currProc].state = 1;
+                totRunning++;
+                STAT_COUNT(toRunning, 1);
+                processes[currProc].runningTimer = cpuBurst(&processes[currProc]);
+
+            }
+
+            if(window.size > 0) {
+                windowTick(processes, readyQ, currTime);
+            }
+
+            currTime++;
+            c = 0;
+
+            for(int i = 0; i < numProcs; i++) {
+                if(processes[i].A == currTime) {
+                    //processes can get started before they arrive,
+                    //those don't go on the queue
+                    if(i > currProc) {
+                        enqueue(readyQ, processes[i].pid); 
+                    }
+                    if(processes[i].state == 1) {
+                        totRunning--;
+                    }
+                    processes[i].state = 0;
+                    STAT_COUNT(toReady, 1);
+                    processes[i].timeIntoRQ = currTime;
+                }
+            }
+
+        }
+        currProc++;
+
+    }
+}
+
+void RR( process processes[], int *readyQ, int *temp ) {
+
+    //set Q to quantum
+    Q = quantum;
+
+    runUntil(RRstep, processes, readyQ, temp, 0, -1);
+}
+
+void RRstep(process processes[], int *readyQ, int *temp, simtime currTime) {
+    int c = 0;
+
+    if(verbose) {
+        printState(processes, currTime);
+    }
+
+    //put all newly created processes in temp array, then
+    //update all blocked and put newly unblocked processes there too
+    c = arrivalsAndBlocked(processes, currTime, temp);
+
+    c = updateRun(processes, currTime, temp, c);
+
+    //put all processes from temp array onto readyQ
+    tempToReady(temp, readyQ, c, currTime, processes);
+
+
+    //if nothing is running and our queue isn't empty, 
+    //put first proc from readyQ in running position
+    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
+        moveProcToRunning(processes, readyQ, currTime);
+    }
+
+    //only the first c slots of temp got used
+    clearArr(temp, c);
+}
+
+void SJF(process processes[], int *readyQ, int *temp) {
+    runUntil(SJFstep, processes, readyQ, temp, 0, -1);
+}
+
+void SJFstep(process processes[], int *readyQ, int *temp, simtime currTime) {
+    int c = 0;
+    int n = 0;
+
+    if(verbose) {
+        printState(processes, currTime);
+    }
+
+    //put all newly created processes in temp array, then
+    //update all blocked and put newly unblocked processes there too
+    c = arrivalsAndBlocked(processes, currTime, temp);
+
+    //put all processes from temp array onto readyQ
+    tempToReady(temp, readyQ, c, currTime, processes);
+
+    n = QSize(readyQ);
+    sortQSJF(readyQ, n, processes);
+
+    c = updateRun(processes, currTime, temp, c);
+
+    //if nothing is running and our queue isn't empty, 
+    //put first proc from readyQ in running position
+    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
+        moveProcToRunning(processes, readyQ, currTime);
+    }
+
+    //only the first c slots of temp got used
+    clearArr(temp, c);
+}
+
+simtime runUntil(stepFn step, process processes[], int *readyQ, int *temp, simtime currTime, long long stopTime) {
+
+    /* runs cycles from currTime until every process is finished
+       or stopTime is reached (-1 for no limit). returns the
+       cycle the next step would start at */
+    while(!allDone(processes) && currTime != stopTime) {
+        step(processes, readyQ, temp, currTime);
+        if(window.size > 0) {
+            windowTick(processes, readyQ, currTime);
+        }
+        currTime++;
+    }
+    return currTime;
+}
+
+/* ============= RUNNING AN INPUT ================ */
+
+int runInput(char *args[], long long forkAt, char *variants, int replicas, traceMap *trace, const char *windowFile) {
+
+    /* args holds the input, the random numbers file and the
+       scheduler. returns main's exit status, or NEEDS_WIDE before
+       anything has run if the input could overflow simtime */
+	FILE *file = fopen( args[0], "r" );
+
+	if ( file == 0 ) {
+        printf( "Could not open file\n" );
+        exit(1);
+    }
+    
+    /* check how many processes there are total */
+    fscanf(file,"%d",&numProcs);
+    
+    /* create an array of numProcesses processes. heap allocated
+       since large inputs would not fit on the stack */
+    process *processes = malloc(numProcs * sizeof(process));
+
+    /* populate array of processes */
+    readFile(file, processes);
+    fclose(file);
+
+    /* sort processes by arrival time */
+    sortProcByArrival(processes);
+
+    if(trace != NULL) {
+        loadTrace(processes, trace);
+    }
+
+    long long bound = maxRuntime(processes, trace);
+    if(bound < 0 || bound > SIMTIME_MAX) {
+        free(processes);
+        return NEEDS_WIDE;
+    }
+
+    /* create a ready queue of size number of processes */
+    int *readyQ = malloc(numProcs * sizeof(int));
+    zeroArr(readyQ);
+
+    /* create temp array */
+    int *temp = malloc(numProcs * sizeof(int));
+    zeroArr(temp);
+    
+    /* open random numbers file */
+    FILE *randomFile = fopen( args[1], "r" );
+
+	if ( randomFile == 0 ) {
+        printf( "Could not open file\n" );
+        exit(1);
+    }
+    readRandomNums(randomFile);
+    fclose(randomFile);
+
+    /* determine which type of scheduler to run */
+    char scheduler = *args[2];
+
+    if(variants != NULL) {
+        /* run the chosen scheduler up to the fork point, then
+           let every variant continue from that shared state */
+        stepFn step = switchScheduler(scheduler, quantum, processes);
+        if(step == NULL) {
+            printf("Forking needs one of the f, s or r schedulers. Exiting.\n");
+            exit(1);
+        }
+        simtime currTime = runUntil(step, processes, readyQ, temp, 0, forkAt);
+        printf("Ran %s until cycle %" PRItime "\n", schedulerName(scheduler), currTime);
+        if(forkContinuations(processes, readyQ, temp, currTime, variants) != 0) {
+            return 1;
+        }
+        return 0;
+    }
+
+    if(replicas > 0) {
+        runReplicas(processes, scheduler, replicas);
+        return 0;
+    }
+
+    if(window.size > 0) {
+        startWindows(windowFile);
+    }
+
+    startWorkers(numWorkers);
+
+    if(runScheduler(scheduler, processes, readyQ, temp) != 0) {
+        printf("Not a valid scheduler. Exiting.\n");
+        exit(1);
+    }
+
+    if(window.size > 0) {
+        windowFlush(processes, readyQ);
+    }
+
+    printResults(processes, scheduler);
+
+    if(stats) {
+        printStats(scheduler);
+    }
+
+    stopWorkers();
+    return 0;
+}
+
+/* ============= SNAPSHOT AND FORK ================ */
+
+stepFn switchScheduler(char scheduler, int q, process processes[]) {
+
+    /* sets up the globals for scheduler and returns its step
+       function, or NULL if it can't be run one cycle at a time.
+       a process already running gets a fresh quantum when
+       switching to RR from another scheduler so it can be preempted */
+    if(scheduler == 'r') {
+        for(int i = 0; Q <= 0 && i < numProcs; i++) {
+            if(processes[i].state == 1) {
+                processes[i].Qtimer = q;
+            }
+        }
+        Q = q;
+        return RRstep;
+    }
+
+    Q = -1;
+    if(scheduler == 'f') return FCFSstep;
+    if(scheduler == 's') return SJFstep;
+    return NULL;
+}
+
+int forkContinuations(process processes[], int *readyQ, int *temp, simtime currTime, char *variants) {
+
+    /* variants is a comma separated list of schedulers, RR
+       optionally followed by its quantum (f,s,r,r4). each one
+       continues from the current state in its own child process,
+       so the snapshot is shared copy-on-write and the children
+       run in parallel. output goes to a temporary file per child
+       and is printed in order once they are all done. returns the
+       number of continuations that failed */
+    int n = 1;
+    for(char *v = variants; *v; v++) {
+        if(*v == ',') n++;
+    }
+
+    pid_t *children = malloc(n * sizeof(pid_t));
+    FILE **outputs = malloc(n * sizeof(FILE *));
+    char **names = malloc(n * sizeof(char *));
+    char *list = strdup(variants);
+    char *tok = strtok(list, ",");
+    n = 0;
+
+    while(tok != NULL) {
+        char scheduler;
+        int q;
+
+        if(parseVariant(tok, &scheduler, &q) != 0) {
+            printf("Skipping continuation '%s': not a valid scheduler\n", tok);
+            tok = strtok(NULL, ",");
+            continue;
+        }
+
+        names[n] = tok;
+        outputs[n] = tmpfile();
+        if(outputs[n] == NULL) {
+            perror("tmpfile");
+            exit(1);
+        }
+        fflush(stdout);
+
+        children[n] = fork();
+        if(children[n] < 0) {
+            perror("fork");
+            exit(1);
+        }
+        if(children[n] == 0) {
+            dup2(fileno(outputs[n]), STDOUT_FILENO);
+
+            stepFn step = switchScheduler(scheduler, q, processes);
+            runUntil(step, processes, readyQ, temp, currTime, -1);
+
+            printf("\n======== continuing with %s", schedulerName(scheduler));
+            if(scheduler == 'r') {
+                printf(" (quantum %d)", q);
+            }
+            printf(" from cycle %" PRItime " ========\n", currTime);
+            printResults(processes, scheduler);
+
+            fflush(stdout);
+            _exit(0);
+        }
+
+        n++;
+        tok = strtok(NULL, ",");
+    }
+
+    char buf[4096];
+    size_t len;
+    int failed = 0;
+    for(int i = 0; i < n; i++) {
+        int status = 0;
+        waitpid(children[i], &status, 0);
+        rewind(outputs[i]);
+        while((len = fread(buf, 1, sizeof(buf), outputs[i])) > 0) {
+            fwrite(buf, 1, len, stdout);
+        }
+        fclose(outputs[i]);
+
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("\nContinuation '%s' failed, its results above are incomplete\n", names[i]);
+            failed++;
+        }
+    }
+
+    free(names);
+    free(list);
+    free(outputs);
+    free(children);
+    return failed;
+}
+
+int runScheduler(char scheduler, process processes[], int *readyQ, int *temp) {
+
+    /* runs scheduler to completion, returns -1 if it isn't one */
+    switch(scheduler) {
+        case('f'):
+            FCFS(processes, readyQ, temp);
+            break;
+        case('u'):
+            uniprogrammed(processes, readyQ, temp);
+            break;
+        case('r'):
+            RR(processes, readyQ, temp);
+            break;
+        case('s'):
+            SJF(processes, readyQ, temp);
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+/* ============= MONTE CARLO REPLICAS ================ */
+
+typedef struct {
+    process *initial; /* process table before anything ran */
+    char scheduler;
+    int k; /* number of replicas */
+    int next; /* next replica to hand out */
+    int *offsets; /* rng offset each replica starts at */
+    summary *results;
+    double *wallTime; /* milliseconds per replica */
+    long long *draws; /* random numbers each replica used */
+} replicaJob;
+
+double elapsedMs(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+void *replicaWorker(void *arg) {
+
+    /* keeps taking replicas off the job until there are none left.
+       the simulation globals are thread local, so each worker only
+       needs its own copy of the process table and queues */
+    replicaJob *job = arg;
+    process *processes = malloc(numProcs * sizeof(process));
+    int *readyQ = malloc(numProcs * sizeof(int));
+    int *temp = malloc(numProcs * sizeof(int));
+    struct timespec start, end;
+    int r;
+
+    while((r = __sync_fetch_and_add(&job->next, 1)) < job->k) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        memcpy(processes, job->initial, numProcs * sizeof(process));
+        zeroArr(readyQ);
+        zeroArr(temp);
+        rngCursor = job->offsets[r];
+        rngDraws = 0;
+        Q = -1;
+        finalFinish = 0;
+        totCPU = 0;
+        totIO = 0;
+        totFinished = 0;
+        totRunning = 0;
+        qLen = 0;
+
+        runScheduler(job->scheduler, processes, readyQ, temp);
+        job->results[r] = computeSummary(processes);
+        job->draws[r] = rngDraws;
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        job->wallTime[r] = elapsedMs(start, end);
+    }
+
+    free(temp);
+    free(readyQ);
+    free(processes);
+    return NULL;
+}
+
+double tCritical(int df) {
+    /* two sided 95% critical values of student's t, normal past 30 */
+    static const double t[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if(df < 1) return 0;
+    if(df <= 30) return t[df-1];
+    return 1.960;
+}
+
+void printInterval(const char *name, double *x, int k) {
+    double mean = 0;
+    double var = 0;
+    for(int i = 0; i < k; i++) {
+        mean += x[i];
+    }
+    mean /= k;
+    for(int i = 0; i < k; i++) {
+        var += (x[i] - mean) * (x[i] - mean);
+    }
+    if(k < 2) {
+        //one sample says nothing about the spread
+        printf("\t%-20s mean %12f  stddev          n/a  95%% CI n/a\n", name, mean);
+        return;
+    }
+    double sd = sqrt(var / (k - 1));
+    double h = tCritical(k - 1) * sd / sqrt(k);
+    printf("\t%-20s mean %12f  stddev %12f  95%% CI [%f, %f]\n", name, mean, sd, mean - h, mean + h);
+}
+
+void runReplicas(process processes[], char scheduler, int k) {
+
+    /* runs k copies of the workload, replica i starting at an
+       evenly spaced offset into the random numbers (replica 0 is
+       the normal run), spread over one thread per core */
+    if(strchr("fsur", scheduler) == NULL) {
+        printf("Not a valid scheduler. Exiting.\n");
+        exit(1);
+    }
+
+    if(k > numRandom) {
+        printf("--replicas can be at most %d, the number of random numbers, or some replicas would be copies of others. Exiting.\n", numRandom);
+        exit(1);
+    }
+
+    replicaJob job;
+    job.initial = processes;
+    job.scheduler = scheduler;
+    job.k = k;
+    job.next = 0;
+    job.offsets = malloc(k * sizeof(int));
+    job.results = malloc(k * sizeof(summary));
+    job.wallTime = malloc(k * sizeof(double));
+    job.draws = malloc(k * sizeof(long long));
+    for(int i = 0; i < k; i++) {
+        job.offsets[i] = (int)(((long long) i * numRandom) / k);
+    }
+
+    int nThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if(nThreads < 1) nThreads = 1;
+    if(nThreads > k) nThreads = k;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t *threads = malloc(nThreads * sizeof(pthread_t));
+    for(int i = 0; i < nThreads; i++) {
+        pthread_create(&threads[i], NULL, replicaWorker, &job);
+    }
+    for(int i = 0; i < nThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("The scheduling process used was %s\n", schedulerName(scheduler));
+    printf("%d replicas on %d threads in %.3f ms\n\n", k, nThreads, elapsedMs(start, end));
+
+    for(int i = 0; i < k; i++) {
+        summary *s = &job.results[i];
+        printf("Replica %d (offset %d): %.3f ms\n", i, job.offsets[i], job.wallTime[i]);
+        printf("\tfinish %" PRItime "  cpu %f  io %f  thru %f  turn %f  wait %f\n",
+            s->finish, s->cpuU, s->ioU, s->thru, s->avgTurn, s->avgWait);
+    }
+
+    /* a replica that draws more than the gap to the next one's
+       offset runs into that one's stream, from then on both see
+       the same numbers shifted, and the samples aren't independent */
+    long long maxDraws = 0;
+    for(int i = 0; i < k; i++) {
+        if(job.draws[i] > maxDraws) maxDraws = job.draws[i];
+    }
+    if(k > 1 && maxDraws > numRandom / k) {
+        printf("\nWarning: replicas used up to %lld random numbers but start only %d apart, so their\n"
+            "streams overlap and the intervals below are too narrow. Use fewer replicas or more random numbers.\n",
+            maxDraws, numRandom / k);
+    }
+
+    double *x = malloc(k * sizeof(double));
+    printf("\nReplica Summary Data: \n");
+
+    for(int i = 0; i < k; i++) x[i] = job.results[i].finish;
+    printInterval("Finishing Time:", x, k);
+    for(int i = 0; i < k; i++) x[i] = job.results[i].cpuU;
+    printInterval("CPU Utilization:", x, k);
+    for(int i = 0; i < k; i++) x[i] = job.results[i].ioU;
+    printInterval("I/O Utilization:", x, k);
+    for(int i = 0; i < k; i++) x[i] = job.results[i].thru;
+    printInterval("Throughput:", x, k);
+    for(int i = 0; i < k; i++) x[i] = job.results[i].avgTurn;
+    printInterval("Turnaround Time:", x, k);
+    for(int i = 0; i < k; i++) x[i] = job.results[i].avgWait;
+    printInterval("Waiting Time:", x, k);
+
+    free(x);
+    free(threads);
+    free(job.draws);
+    free(job.wallTime);
+    free(job.results);
+    free(job.offsets);
+}
+
+/* ============= PARALLEL TICK ================ */
+
+#define SPIN_LIMIT 1000 /* spins before a waiting thread starts yielding */
+
+typedef struct {
+    int count; /* threads still to arrive */
+    int total;
+    int sense; /* flips every time all threads have arrived */
+} spinBarrier;
+
+struct {
+    int pass; /* what the workers do after the next barrier */
+    process *processes;
+    simtime currTime;
+    int q;
+    partition *parts; /* one contiguous slice of the table per thread */
+    pthread_t *threads;
+    spinBarrier barrier;
+} workers;
+
+__thread int barrierSense = 0;
+
+void barrierWait(spinBarrier *b) {
+
+    /* sense reversing barrier: the last thread to arrive resets
+       the count and flips the sense everyone else is spinning on */
+    int sense = !barrierSense;
+    barrierSense = sense;
+
+    if(__atomic_sub_fetch(&b->count, 1, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_store_n(&b->count, b->total, __ATOMIC_RELAXED);
+        __atomic_store_n(&b->sense, sense, __ATOMIC_RELEASE);
+    }
+    else {
+        int spins = 0;
+        while(__atomic_load_n(&b->sense, __ATOMIC_ACQUIRE) != sense) {
+            if(++spins > SPIN_LIMIT) {
+                sched_yield();
+            }
+        }
+    }
+}
+
+void runPass(int id) {
+    partition *part = &workers.parts[id];
+    part->n = 0;
+    part->nDraws = 0;
+    part->busy = 0;
+    part->cpu = 0;
+    part->finished = 0;
+    part->nArrived = 0;
+    part->stopped = 0;
+
+    switch(workers.pass) {
+        case(PASS_ARRIVALS_BLOCKED):
+            arrivalsRange(workers.processes, workers.currTime, part);
+            blockedRange(workers.processes, part);
+            break;
+        case(PASS_BLOCKED):
+            blockedRange(workers.processes, part);
+            break;
+        case(PASS_RUN):
+            runRange(workers.processes, workers.currTime, workers.q, part);
+            break;
+    }
+}
+
+void *workerLoop(void *arg) {
+    int id = (int)(long) arg;
+
+    while(1) {
+        barrierWait(&workers.barrier);
+        if(workers.pass == PASS_EXIT) {
+            break;
+        }
+        runPass(id);
+        barrierWait(&workers.barrier);
+    }
+    return NULL;
+}
+
+void startWorkers(int n) {
+
+    /* splits the process table into n slices, the main thread
+       takes the first and a new thread each of the others */
+    if(n <= 1) {
+        return;
+    }
+
+    workers.parts = malloc(n * sizeof(partition));
+    for(int i = 0; i < n; i++) {
+        partition *part = &workers.parts[i];
+        part->lo = (int)(((long long) i * numProcs) / n);
+        part->hi = (int)(((long long) (i + 1) * numProcs) / n);
+        part->list = malloc((part->hi - part->lo + 1) * sizeof(int));
+        part->draws = malloc((part->hi - part->lo + 1) * sizeof(int));
+        part->arrived = malloc((part->hi - part->lo + 1) * sizeof(int));
+    }
+
+    workers.barrier.count = n;
+    workers.barrier.total = n;
+    workers.barrier.sense = 0;
+
+    workers.threads = malloc(n * sizeof(pthread_t));
+    for(int i = 1; i < n; i++) {
+        pthread_create(&workers.threads[i], NULL, workerLoop, (void *)(long) i);
+    }
+}
+
+void stopWorkers() {
+    if(numWorkers <= 1) {
+        return;
+    }
+
+    workers.pass = PASS_EXIT;
+    barrierWait(&workers.barrier);
+    for(int i = 1; i < numWorkers; i++) {
+        pthread_join(workers.threads[i], NULL);
+    }
+
+    for(int i = 0; i < numWorkers; i++) {
+        free(workers.parts[i].list);
+        free(workers.parts[i].draws);
+        free(workers.parts[i].arrived);
+    }
+    free(workers.parts);
+    free(workers.threads);
+    numWorkers = 1;
+}
+
+int parallelPass(int pass, process processes[], simtime currTime, int *temp, int c) {
+
+    /* runs one pass with every thread on its own slice, then merges
+       the slices in table order so temp, the random numbers drawn and
+       the totals come out exactly as in a single threaded pass.
+       arrivals all go ahead of the other pids, as when newPtoTemp runs
+       before updateBlocked. returns c plus the pids added to temp */
+    workers.pass = pass;
+    workers.processes = processes;
+    workers.currTime = currTime;
+    workers.q = Q;
+
+    barrierWait(&workers.barrier);
+    runPass(0);
+    barrierWait(&workers.barrier);
+
+    int busy = 0;
+    int finished = 0;
+    int stopped = 0;
+    for(int i = 0; i < numWorkers; i++) {
+        partition *part = &workers.parts[i];
+        if(part->nArrived > 0) {
+            memcpy(temp + c, part->arrived, part->nArrived * sizeof(int));
+            c += part->nArrived;
+        }
+    }
+    for(int i = 0; i < numWorkers; i++) {
+        partition *part = &workers.parts[i];
+
+        if(part->n > 0) {
+            memcpy(temp + c, part->list, part->n * sizeof(int));
+            c += part->n;
+        }
+        for(int d = 0; d < part->nDraws; d++) {
+            process *p = &processes[part->draws[d]];
+            p->blockedTimer = ioBurst(p);
+        }
+        busy |= part->busy;
+        finished += part->finished;
+        stopped += part->stopped;
+        totCPU += part->cpu;
+    }
+
+    if(pass != PASS_RUN && busy) { totIO += 1; }
+    if(pass == PASS_RUN && finished) { finalFinish = currTime; }
+    if(pass == PASS_RUN) { totFinished += finished; }
+    if(pass == PASS_RUN) { totRunning -= stopped; }
+    if(pass == PASS_RUN) { STAT_COUNT(toFinished, finished); }
+    return c;
+}
+
+/* ============= TIME SERIES ================ */
+
+#define WINDOW_BUF 65536 /* bytes of rows held before they are written */
+
+void startWindows(const char *path) {
+
+    /* rows go through a fixed size stdio buffer, so a long run
+       costs one write every few hundred windows */
+    static char buf[WINDOW_BUF];
+
+    window.out = fopen(path, "w");
+    if(window.out == NULL) {
+        printf( "Could not open file\n" );
+        exit(1);
+    }
+    setvbuf(window.out, buf, _IOFBF, sizeof(buf));
+    fprintf(window.out, "start,end,cpu_utilization,io_utilization,ready_queue,arrivals,completions\n");
+
+    window.start = 0;
+    window.last = -1;
+    window.left = window.size;
+    window.cpu = 0;
+    window.io = 0;
+    window.finished = 0;
+    window.nextArrival = 0;
+}
+
+void writeWindow(process processes[], int *readyQ) {
+
+    /* one row for the cycles from window.start to window.last.
+       processes are sorted by arrival, so arrivals are counted by
+       walking forward from where the last window stopped. the
+       ready queue length is the one at the end of the window */
+    long long cycles = window.last - window.start + 1;
+    int arrivals = 0;
+    while(window.nextArrival < numProcs && processes[window.nextArrival].A <= window.last) {
+        window.nextArrival++;
+        arrivals++;
+    }
+
+    fprintf(window.out, "%lld,%lld,%f,%f,%d,%d,%d\n", window.start, window.last,
+        (double)(totCPU - window.cpu) / cycles, (double)(totIO - window.io) / cycles,
+        QSize(readyQ), arrivals, totFinished - window.finished);
+
+    window.start = window.last + 1;
+    window.left = window.size;
+    window.cpu = totCPU;
+    window.io = totIO;
+    window.finished = totFinished;
+}
+
+void windowTick(process processes[], int *readyQ, simtime currTime) {
+    //called once currTime's cycle is over
+    window.last = currTime;
+    if(--window.left == 0) {
+        writeWindow(processes, readyQ);
+    }
+}
+
+void windowFlush(process processes[], int *readyQ) {
+    //writes out whatever is left of the last window
+    if(window.last >= window.start) {
+        writeWindow(processes, readyQ);
+    }
+    fclose(window.out);
+}
+
+/* ============= BATCH ================ */
+
+void printJSONString(const char *str) {
+    //control characters can't appear raw in a JSON string
+    putchar('"');
+    for(; *str; str++) {
+        unsigned char c = *str;
+        if(c == '"' || c == '\\') {
+            printf("\\%c", c);
+        }
+        else if(c == '\n') {
+            printf("\\n");
+        }
+        else if(c == '\t') {
+            printf("\\t");
+        }
+        else if(c == '\r') {
+            printf("\\r");
+        }
+        else if(c < 0x20) {
+            printf("\\u%04x", c);
+        }
+        else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+void printCSVString(const char *str) {
+    //quoted as in RFC 4180, with any quotes inside doubled
+    putchar('"');
+    for(; *str; str++) {
+        if(*str == '"') {
+            putchar('"');
+        }
+        putchar(*str);
+    }
+    putchar('"');
+}
+
+void printBatchRun(const char *path, char scheduler, process processes[], int csv) {
+
+    /* a row per process followed by one for the whole run. in csv
+       both kinds of rows share a header, with the columns that
+       don't apply left empty */
+    summary s = computeSummary(processes);
+
+    for(int i = 0; i < numProcs; i++) {
+        process *p = &processes[i];
+        if(csv) {
+            printf("process,");
+            printCSVString(path);
+            printf(",%c,%d,,%d,%d,%d,%d,%" PRItime ",%" PRItime ",%" PRItime ",%" PRItime ",,,,,\n", scheduler, i,
+                p->A, p->B, p->C, p->IO, p->finishTime, p->finishTime - p->A, p->IOtime, p->waitTime);
+        }
+        else {
+            printf("{\"record\":\"process\",\"file\":");
+            printJSONString(path);
+            printf(",\"scheduler\":\"%c\",\"process\":%d,\"A\":%d,\"B\":%d,\"C\":%d,\"IO\":%d,"
+                "\"finish\":%" PRItime ",\"turnaround\":%" PRItime ",\"io_time\":%" PRItime ",\"wait\":%" PRItime "}\n", scheduler, i,
+                p->A, p->B, p->C, p->IO, p->finishTime, p->finishTime - p->A, p->IOtime, p->waitTime);
+        }
+    }
+
+    if(csv) {
+        printf("run,");
+        printCSVString(path);
+        printf(",%c,,%d,,,,,%" PRItime ",,,,%f,%f,%f,%f,%f\n", scheduler, numProcs,
+            s.finish, s.cpuU, s.ioU, s.thru, s.avgTurn, s.avgWait);
+    }
+    else {
+        printf("{\"record\":\"run\",\"file\":");
+        printJSONString(path);
+        printf(",\"scheduler\":\"%c\",\"processes\":%d,\"finish\":%" PRItime ",\"cpu_utilization\":%f,"
+            "\"io_utilization\":%f,\"throughput\":%f,\"avg_turnaround\":%f,\"avg_wait\":%f}\n",
+            scheduler, numProcs, s.finish, s.cpuU, s.ioU, s.thru, s.avgTurn, s.avgWait);
+    }
+}
+
+/* process table and queues reused by batchFile, they only get
+   reallocated when an input has more processes than any before it */
+struct {
+    process *processes;
+    int *readyQ;
+    int *temp;
+    int capacity;
+} batch;
+
+int batchFile(const char *path, char scheduler, int csv) {
+
+    /* runs one input of a batch and prints its rows. returns -1
+       if it can't be read, NEEDS_WIDE if it could overflow simtime */
+    FILE *file = fopen(path, "r");
+    if(file == 0 || fscanf(file, "%d", &numProcs) != 1 || numProcs <= 0) {
+        if(file != 0) fclose(file);
+        return -1;
+    }
+
+    if(numProcs > batch.capacity) {
+        batch.capacity = numProcs;
+        batch.processes = realloc(batch.processes, batch.capacity * sizeof(process));
+        batch.readyQ = realloc(batch.readyQ, batch.capacity * sizeof(int));
+        batch.temp = realloc(batch.temp, batch.capacity * sizeof(int));
+    }
+
+    readFile(file, batch.processes);
+    fclose(file);
+    sortProcByArrival(batch.processes);
+
+    long long bound = maxRuntime(batch.processes, NULL);
+    if(bound < 0 || bound > SIMTIME_MAX) {
+        return NEEDS_WIDE;
+    }
+    zeroArr(batch.readyQ);
+    zeroArr(batch.temp);
+
+    rngCursor = 0;
+    Q = -1;
+    finalFinish = 0;
+    totCPU = 0;
+    totIO = 0;
+    totFinished = 0;
+    totRunning = 0;
+    qLen = 0;
+
+    runScheduler(scheduler, batch.processes, batch.readyQ, batch.temp);
+    printBatchRun(path, scheduler, batch.processes, csv);
+    return 0;
+}
+
+void freeBatch() {
+    free(batch.temp);
+    free(batch.readyQ);
+    free(batch.processes);
+}
+
+#undef SIMTIME_MAX
+#undef PRItime
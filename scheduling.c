@@ -1,839 +1,529 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <errno.h>
 #include <getopt.h>
+#include <string.h>
 #include <strings.h>
 #include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+
+
+/* ================= parallel passes ================= */
 
+/* per-cycle passes over the process table that can be split
+   between worker threads, see parallelPass */
+enum { PASS_ARRIVALS_BLOCKED, PASS_BLOCKED, PASS_RUN, PASS_EXIT };
 
 
-/*  ================== process struct ================= */
+/* ================= stats ================= */
+
+/* counters and phase timers for --stats. building with -DNO_STATS
+   compiles them out, otherwise they cost a branch when off */
+enum { PHASE_ARRIVALS, PHASE_BLOCKED, PHASE_READY, PHASE_SORT, PHASE_RUN, PHASE_DISPATCH, PHASE_ARRIVALS_BLOCKED, NUM_PHASES };
 
 typedef struct {
-	int A; /* arrival time */
-	int B; /* burst time */
-	int C; /* total CPU time */
-	int IO; /* IO burst time */
-    int pid; /* process id number (based on loc in input file) */
-	int waitTime; /* time in ready state */
-	int IOtime; /* time in blocked state */
-	int finishTime; /* finishing time */
-	int state; /* -1:unstarted, 0:ready, 1:running, 2:blocked, 3:finished */
-	int blockedTimer; /* time remaining in blocked state */
-	int runningTimer; /* time remaining in running state */
-    int CPUleft; /* how much time left until finished */
-    int timeIntoRQ; /* time when last got placed in ready Q */
-    int justBlocked; /* flag whether or not JUST got out of blocked state */
-    int Qtimer; /* for RR, current quantum timer */
-} process;
-
-/* ================= helper functions declarations ================= */
-
-int randomOS(FILE *file, int U, int CPUleft);
-int getBurstTime();
-void printProcess(process p);
-void printProcessSummary(process p);
-void printState(process processes[], int currTime);
-void printFinalSummary(process processes[]);
-void printQ(int *q);
-void printT(int *q);
-void enqueue(int *q, int p);
-int dequeue(int *q);
-int qIsEmpty(int *q);
-void sortQSJF(int *temp, int n, process processes[]);
-int QSize(int *q);
-int newPtoTemp(process processes[], int currTime, int *temp);
-void tempToReady(int *temp, int *q, int c, int currTime, process processes[]);
-process createProcess(int a, int b, int c, int io, int id );
-void sortProcByArrival(process processes[]);
-void readFile(FILE *file, process processes[]);
-void tieBreak(int *temp, int n, process processes[]);
-int updateBlocked(process processes[], int *temp, int c);
-int updateRun(process processes[], int currTime, int *temp, int c);
-int somethingRunning(process processes[]);
-void updateQ(process processes[], int *q, int currTime, int *temp, int c);
-void moveProcToRunning(process processes[], int *q, int currTime);
-int allDone(process processes[]);
-void zeroArr(int *arr);
-
-/* ================= schedulers ================= */
-
-void FCFS(process processes[], int *readyQ, int *temp);
-void uniprogrammed(process processes[], int *readyQ, int *temp);
-void RR( process processes[], int *readyQ, int *temp );
-void SJF( process processes[], int *readyQ, int *temp );
+    unsigned long long calls;
+    unsigned long long ticks; /* timer ticks spent in the phase */
+} phaseStat;
 
+typedef struct {
+    unsigned long long enqueues;
+    unsigned long long dequeues;
+    unsigned long long comparisons; /* made by tieBreak and sortQSJF */
+    unsigned long long randomDraws;
+    unsigned long long traceReads;
+    unsigned long long toReady;
+    unsigned long long toRunning;
+    unsigned long long toBlocked;
+    unsigned long long toFinished;
+} statCounters;
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TIMER_NAME "tsc"
+#define readTimer() __builtin_ia32_rdtsc()
+#else
+#define TIMER_NAME "ns"
+unsigned long long readTimer() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#ifdef NO_STATS
+#define STAT_COUNT(name, n)
+#define STAT_START(t)
+#define STAT_STOP(phase, t)
+#else
+#define STAT_COUNT(name, n) do { if(stats) counters.name += (n); } while(0)
+#define STAT_START(t) unsigned long long t = stats ? readTimer() : 0
+#define STAT_STOP(phase, t) do { if(stats) { phases[phase].calls++; phases[phase].ticks += readTimer() - t; } } while(0)
+#endif
+
+void readRandomNums(FILE *file);
+long long parseCycle(const char *str, char **end);
+int parseVariant(const char *tok, char *scheduler, int *q);
+int runBatch(char *args[], int n, const char *format);
+
+
+/* ================= trace ================= */
+
+/* the --trace file, mapped and checked by mapTrace before either
+   core runs so the clock width can take the bursts into account */
+typedef struct {
+    int lines;
+    const char **start; /* first character of each line */
+    const char **end; /* end of each line */
+    long long *total; /* sum of the bursts on each line */
+} traceMap;
+
+traceMap *mapTrace(const char *path);
+long long parseTraceValue(const char **cursor, const char *end);
+int isTraceSeparator(char c);
 
 
 /* ================= global variables ================= */
 
 int numProcs = 0;
-FILE *randomNums;
-int Q = -1; /* gets set in RR */
-int finalFinish;
-int totCPU;
-int totIO;
+int *randomNums; /* contents of the random numbers file */
+int numRandom = 0;
+int quantum = 2; /* quantum RR runs with, see --quantum */
 int verbose = 0;
+int numWorkers = 1; /* threads splitting each cycle's passes, see --threads */
+int stats = 0; /* collect counters and phase timers, see --stats */
+statCounters counters;
+phaseStat phases[NUM_PHASES];
+
+/* running totals for --window */
+struct {
+    int size; /* cycles per window, 0 when off */
+    FILE *out;
+    long long start; /* first cycle of the current window */
+    long long last; /* last cycle seen */
+    int left; /* cycles left in the current window */
+    long long cpu; /* totCPU when the window started */
+    long long io; /* totIO when the window started */
+    int finished; /* totFinished when the window started */
+    int nextArrival; /* first process (in arrival order) yet to arrive */
+} window;
+
+/* state of a single simulation. thread local so replicas
+   can run side by side in their own threads */
+__thread int rngCursor = 0; /* index of the next random number to hand out */
+__thread long long rngDraws; /* random numbers handed out so far */
+__thread int Q = -1; /* quantum, gets set in RR */
+__thread long long finalFinish;
+__thread long long totCPU;
+__thread long long totIO;
+__thread int totFinished; /* processes finished so far */
+__thread int totRunning; /* processes in the running state */
+__thread int qLen; /* processes on the ready queue */
+
+
+/* ================= the two cores ================= */
+
+/* core.h holds everything that depends on how wide simtime is.
+   it's compiled once with 32 bit times, which keep the process
+   table small, and once with 64 bit times for runs that can go
+   past 2^31 cycles. main runs the 32 bit core and only falls back
+   to the 64 bit one when maxRuntime says the input could overflow
+   it. NEEDS_WIDE is what a core returns when that happens */
+#define NEEDS_WIDE (-2)
+
+#define TIME_BITS 32
+#include "core.h"
+#undef TIME_BITS
+
+#define TIME_BITS 64
+#include "core.h"
+#undef TIME_BITS
 
 
 /* ================= main program ================= */
 
 int main( int argc, char *argv[] ) {
 
+    long long forkAt = -1; /* cycle to fork continuations at, see --fork */
+    char *variants = NULL;
+    int replicas = 0; /* independent runs to aggregate, see --replicas */
+    char *traceFile = NULL; /* recorded bursts to replay, see --trace */
+    char *windowFile = NULL; /* where --window rows go */
+    char *batchFormat = NULL; /* csv or jsonl, see --batch */
+
+    static struct option longOpts[] = {
+        {"verbose", no_argument, NULL, 'v'},
+        {"quantum", required_argument, NULL, 'q'},
+        {"fork", required_argument, NULL, 'F'},
+        {"replicas", required_argument, NULL, 'R'},
+        {"threads", required_argument, NULL, 'T'},
+        {"trace", required_argument, NULL, 't'},
+        {"stats", no_argument, NULL, 'S'},
+        {"window", required_argument, NULL, 'W'},
+        {"batch", required_argument, NULL, 'B'},
+        {0, 0, 0, 0}
+    };
 
     /* deal with command line arguments */
-    if(strcmp(argv[1], "--verbose") == 0) {
-        verbose = 1;
+    int opt;
+    while((opt = getopt_long(argc, argv, "", longOpts, NULL)) != -1) {
+        switch(opt) {
+            case('v'):
+                verbose = 1;
+                break;
+            case('q'):
+                quantum = atoi(optarg);
+                if(quantum <= 0) {
+                    printf("Quantum must be positive. Exiting.\n");
+                    exit(1);
+                }
+                break;
+            case('F'):
+                /* CYCLE:LIST, e.g. 500:f,s,r,r4 */
+                forkAt = parseCycle(optarg, &variants);
+                if(forkAt < 0 || *variants != ':') {
+                    printf("--fork expects CYCLE:SCHEDULERS with CYCLE from 0 to %lld. Exiting.\n", LLONG_MAX);
+                    exit(1);
+                }
+                variants++;
+                break;
+            case('R'):
+                replicas = atoi(optarg);
+                if(replicas <= 0) {
+                    printf("Replica count must be positive. Exiting.\n");
+                    exit(1);
+                }
+                break;
+            case('t'):
+                traceFile = optarg;
+                break;
+            case('S'):
+#ifdef NO_STATS
+                /* every counter would read 0, which looks like a measurement */
+                printf("--stats isn't available in a build with -DNO_STATS. Exiting.\n");
+                exit(1);
+#else
+                stats = 1;
+#endif
+                break;
+            case('W'):
+                /* CYCLES:FILE, e.g. 10000:windows.csv */
+                window.size = atoi(optarg);
+                windowFile = strchr(optarg, ':');
+                if(windowFile == NULL || window.size <= 0) {
+                    printf("--window expects CYCLES:FILE. Exiting.\n");
+                    exit(1);
+                }
+                windowFile++;
+                break;
+            case('B'):
+                batchFormat = optarg;
+                if(strcmp(batchFormat, "csv") != 0 && strcmp(batchFormat, "jsonl") != 0) {
+                    printf("--batch expects csv or jsonl. Exiting.\n");
+                    exit(1);
+                }
+                break;
+            case('T'):
+                numWorkers = atoi(optarg);
+                if(numWorkers <= 0) {
+                    printf("Thread count must be positive. Exiting.\n");
+                    exit(1);
+                }
+                break;
+            default:
+                exit(1);
+        }
     }
 
-    int loc = 1;
-    if (verbose) {
-        loc++;
+    /* only a batch takes more than one input, anywhere else the
+       extra ones would be read as the random numbers and scheduler */
+    if(argc - optind < 3 || (batchFormat == NULL && argc - optind != 3)) {
+        printf("usage: %s [--verbose] [--quantum N] [--fork CYCLE:SCHEDULERS] [--replicas K] [--threads N] [--trace FILE] [--stats] [--window CYCLES:FILE] input random-numbers [f,s,u,r]\n"
+            "   or: %s --batch csv|jsonl [--quantum N] input... random-numbers [f,s,u,r]\n", argv[0], argv[0]);
+        exit(1);
     }
 
-	FILE *file = fopen( argv[loc], "r" );
+    if(batchFormat != NULL) {
+        if(verbose || variants != NULL || replicas > 0 || traceFile != NULL || stats || window.size > 0 || numWorkers > 1) {
+            printf("--batch can only be combined with --quantum. Exiting.\n");
+            exit(1);
+        }
+        return runBatch(argv + optind, argc - optind, batchFormat) > 0 ? 1 : 0;
+    }
 
-	if ( file == 0 ) {
-        printf( "Could not open file\n" );
+    if(stats && (replicas > 0 || variants != NULL)) {
+        printf("--stats can't be combined with --replicas or --fork. Exiting.\n");
         exit(1);
     }
-    
-    /* check how many processes there are total */
-    fscanf(file,"%d",&numProcs);
-    
-    /* create an array of numProcesses processes */
-    process processes[numProcs]; 
-
-    /* populate array of processes */
-    readFile(file, processes);
-
-    /* sort processes by arrival time */
-    sortProcByArrival(processes);
-
-    /* create a ready queue of size number of processes */
-    int readyQ[numProcs];
-    zeroArr(readyQ);
-
-    /* create temp array */
-    int temp[numProcs];
-    zeroArr(temp);
-    
-    /* open random numbers file */
-    randomNums = fopen( argv[loc+1], "r" );
-
-	if ( randomNums == 0 ) {
-        printf( "Could not open file\n" );
+
+    if(window.size > 0 && (replicas > 0 || variants != NULL)) {
+        printf("--window can't be combined with --replicas or --fork. Exiting.\n");
         exit(1);
     }
 
-    /* determine which type of scheduler to run */
-    char scheduler = *argv[loc+2];
-
-    switch(scheduler) {
-        case('f'):
-            FCFS(processes, readyQ, temp);
-            printf("\nThe scheduling process used was FCFS\n");
-            break;
-        case('u'):
-            uniprogrammed(processes, readyQ, temp);
-            printf("\nThe scheduling process used was uniprogrammed\n");
-            break;
-        case('r'):
-            RR(processes, readyQ, temp);
-            printf("\nThe scheduling process used was Round Robin\n");
-            break;
-        case('s'):
-            SJF(processes, readyQ, temp);
-            printf("\nThe scheduling process used was Shortest Job First\n");
-            break;
-
-        default:
-            printf("Not a valid scheduler. Exiting.\n");
-            exit(1);
+    if(numWorkers > 1 && (replicas > 0 || variants != NULL)) {
+        printf("--threads can't be combined with --replicas or --fork. Exiting.\n");
+        exit(1);
     }
 
-    /* print process summaries */
-    printf("\n");
-    for(int i = 0; i < numProcs; i++) {
-        printf("Process %d:\n", i);
-        printProcessSummary(processes[i]);
-        printf("\n");
+    if(replicas > 0 && (verbose || variants != NULL || traceFile != NULL)) {
+        /* every replica would replay the same trace, so they'd
+           only differ where a line runs out */
+        printf("--replicas can't be combined with --verbose, --fork or --trace. Exiting.\n");
+        exit(1);
     }
 
-    printFinalSummary(processes);
-    
-
-}
-
-/* ================= helper functions declarations ================= */
-
-void printProcess(process p) {
-
-    printf("process id: %d\n", p.pid);
-    printf("arrival time: %d\n", p.A);
-    printf("burst time: %d\n", p.B);
-    printf("total cpu time: %d\n", p.C);
-    printf("io burst time: %d\n", p.IO);
-    printf("current state: %d\n", p.state);
-    printf("time left in blocked state: %d\n", p.blockedTimer);
-    printf("time left in running state: %d\n", p.runningTimer);
-    printf("CPU time left: %d\n", p.CPUleft);
-    printf("total time in ready state so far: %d\n", p.waitTime);
-    printf("total time in blocked state so far: %d\n", p.IOtime);
-    printf("finish time: %d\n", p.finishTime);
-}
-
-void printProcessSummary(process p) {
-    printf("\t(A,B,C,IO) = (%d,%d,%d,%d)\n", p.A, p.B, p.C, p.IO);
-    printf("\tFinishing time: %d\n", p.finishTime);
-    printf("\tTurnaround time: %d\n", (p.finishTime - p.A));
-    printf("\tI/O time: %d\n", p.IOtime);
-    printf("\tWaiting time: %d\n", p.waitTime);
-}
-
-void printState(process processes[], int currTime) {
-    printf("Before cycle %5d: ", currTime);
-    for(int i = 0; i < numProcs; i++) {
-        if(processes[i].state == -1) {
-            printf("%15s %3d ", "unstarted", 0);
-        }
-        else if(processes[i].state == 0) {
-            printf("%15s %3d ","ready", 0);
-        }
-        else if(processes[i].state == 1) {
-            printf("%15s %3d ", "running", processes[i].runningTimer);
+    if(variants != NULL) {
+        /* make sure there's something to continue with before
+           spending cycles on the shared prefix */
+        int valid = 0;
+        char *list = strdup(variants);
+        for(char *tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")) {
+            char scheduler;
+            int q;
+            if(parseVariant(tok, &scheduler, &q) == 0) valid++;
         }
-        else if(processes[i].state == 2) {
-            printf("%15s %3d ", "blocked", processes[i].blockedTimer);
-        }
-        else {
-            printf("%15s %3d ", "finished", 0);
+        free(list);
+        if(valid == 0) {
+            printf("--fork needs at least one of f, s, r or rQUANTUM after the cycle. Exiting.\n");
+            exit(1);
         }
     }
-    printf("\n");
-}
 
-void printFinalSummary(process processes[]) {
-
-    double cpuU = (double) totCPU / (double) finalFinish;
-    double ioU = (double) totIO / (double) finalFinish;
-    double thru; 
-
-    int turn = 0;
-    int wait = 0;
-    for(int i = 0; i < numProcs; i++) {
-        turn += (processes[i].finishTime - processes[i].A);
-        wait += (processes[i].waitTime);
-        totCPU += processes[i].C;
+    traceMap *trace = NULL;
+    if(traceFile != NULL) {
+        trace = mapTrace(traceFile);
     }
 
-    double avgTurn = (double)turn / (double) numProcs;
-    double avgWait = (double) wait / (double) numProcs;
-    thru = 100 / ((double)(finalFinish) / (double) numProcs);
-
-
-    printf("Summary Data: \n");
-    printf("\tFinishing Time: %d\n", finalFinish);
-    printf("\tCPU Utilization: %f\n", cpuU);
-    printf("\tI/O Utilization: %f\n", ioU);
-    printf("\tThroughput: %f processes per hundred cycles\n", thru);
-    printf("\tAverage turnaround Time: %f\n", avgTurn);
-    printf("\tAverage waiting Time: %f\n", avgWait);
-}
-
-void printQ(int *q) {
-    printf("Ready Queue");
-    for (int i = 0; i < numProcs; i++) {
-        printf(" : %d", q[i]);
+    int status = runInput32(argv + optind, forkAt, variants, replicas, trace, windowFile);
+    if(status == NEEDS_WIDE) {
+        status = runInput64(argv + optind, forkAt, variants, replicas, trace, windowFile);
     }
-    printf("\n");
-}
-
-void printT(int *q) {
-    printf("Temp Array");
-    for (int i = 0; i < numProcs; i++) {
-        printf(" : %d", q[i]);
+    if(status == NEEDS_WIDE) {
+        printf("This input can run for more cycles than a 64 bit clock can count. Exiting.\n");
+        exit(1);
     }
-    printf("\n");
+    return status;
 }
 
-process createProcess(int a, int b, int c, int io, int id ) {
-    process newProcess = {
-        a,
-        b,
-        c,
-        io,
-        id,
-        0,
-        0,
-        0,
-        -1,
-        0,
-        0,
-        c,
-        0,
-        0,
-        0
-    };
+/* ================= shared helpers ================= */
 
-    return newProcess;        
-}
+void readRandomNums(FILE *file) {
 
-void sortProcByArrival(process processes[]) {
-    int c,d;
-    process t;
-    int n = numProcs;
-
-    for (c = 1 ; c <= n - 1; c++) {
-        d = c;
-     
-        while ( d > 0 && processes[d].A < processes[d-1].A) {
-          t = processes[d];
-          processes[d] = processes[d-1];
-          processes[d-1] = t;
-          d--;
-        }
-    }
+    /* reads the whole random numbers file into memory so
+       the position in it is just rngCursor, which gets
+       copied along with the rest of the simulation state */
+    int cap = 1024;
+    int r;
+    randomNums = malloc(cap * sizeof(int));
 
-    for(int i = 0; i < numProcs; i++) {
-        processes[i].pid = i;
-    }
-}
-
-void enqueue(int *q, int p) {
-    //place a process at back of array
-	//printf("*****ENQUEUEING NOW!*****\n");
-
-    for(int i = 0; i < numProcs; i++) {
-        if(q[i] == -1) {
-            q[i] = p;
-            break;
+    while(fscanf(file, "%d", &r) == 1) {
+        if(numRandom == cap) {
+            cap *= 2;
+            randomNums = realloc(randomNums, cap * sizeof(int));
         }
+        randomNums[numRandom++] = r;
     }
-}
-
-int dequeue(int *q) {
-    //remove first item from array and shift all others up
 
-    //printf("*****DEQUEUEING NOW!*****\n");
-
-    int pid = q[0]; //if array is empty, q[0] = -1 which is good
-    
-    //shift all elements up
-    for (int i = 0; i < numProcs-1; i++) {
-        q[i] = q[i+1];
+    if(numRandom == 0) {
+        printf("Random numbers file is empty. Exiting.\n");
+        exit(1);
     }
-    q[numProcs-1] = -1; //to preserve integrity of queue 
-
-    return pid;
 }
 
-int qIsEmpty(int *q) {
-    for(int i = 0; i < numProcs; i++) {
-        if (q[i] != -1) return 0;
+traceMap *mapTrace(const char *path) {
+
+    /* maps the trace file and splits it into lines. line i holds
+       alternating CPU and I/O bursts for process i (numbered by
+       arrival, as in the output). every burst gets read once here,
+       to check it and add up each line for maxRuntime, and after
+       that only as it's used, so the file is never read into memory
+       and the kernel can drop pages of it as it likes. the mapping
+       stays around until the program exits */
+    traceMap *trace = calloc(1, sizeof(traceMap));
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        printf( "Could not open file\n" );
+        exit(1);
     }
-    return 1;
-}
-
-int newPtoTemp(process processes[], int currTime, int *temp) {
-    //puts processes created at currTime in temp array
-    //returns number of processes just added
-    int c = 0;
-    for(int i = 0; i < numProcs; i++) {
-        if(processes[i].A == currTime) {
-            temp[c] = processes[i].pid;
-            c++;
-        }
+    if(st.st_size == 0) {
+        close(fd);
+        return trace;
     }
-    return c;
-}
 
-void tempToReady(int *temp, int *q, int c, int currTime, process processes[]) {
-    //moves all c process from temp array to readyQ with ties taken care of
-    //sets these processes arrival to Q time as current time
-    tieBreak(temp,c,processes);
-    
-    for(int i = 0; i < c; i++) {
-        enqueue(q, temp[i]);
-        processes[temp[i]].timeIntoRQ = currTime;
-        processes[temp[i]].state = 0;
+    const char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
     }
-}
 
-void updateQ(process processes[], int *q, int currTime, int *temp, int c) {
+    const char *end = data + st.st_size;
+    const char *line = data;
+    int cap = 0;
+    while(line < end) {
+        const char *nl = memchr(line, '\n', end - line);
+        if(nl == NULL) nl = end;
 
-	//printf("***** UPDATING QUEUE NOW!*****\n");
-    // increments wait counter for all processes that are in ready Q
-    // adds elements that have just arrived to temporary buffer
-    for(int i = 0; i < numProcs; i++) {
-        //check if in ready state
-        if(processes[i].state == 0) {
-            processes[i].waitTime += 1;
-        }
-        if(processes[i].state == -1 && processes[i].A == currTime) {
-            //put these in temporary buffer
-            temp[c] = processes[i].pid;
-            c++;
+        if(trace->lines == cap) {
+            cap = cap ? cap * 2 : 1024;
+            trace->start = realloc(trace->start, cap * sizeof(char *));
+            trace->end = realloc(trace->end, cap * sizeof(char *));
+            trace->total = realloc(trace->total, cap * sizeof(long long));
         }
-        //at this point we should have all the elements
-        //that may need to get into the actual ready q in 
-        //the temp buffer. add them in proper order (tie 
-        //breakers) to readyQ 
-        if(c > 0) {
-            tieBreak(temp, c, processes);
-            for(int i = 0; i < c; i++) {
-                enqueue(q, temp[i]);
-            }
-        } 
-    }
-}
-
-int updateRun(process processes[], int currTime , int *temp, int c) {
-
-    /* this function decrements the current running timer for the
-       running process. if the timer reaches 0, state moves to 
-       finished with finish time = curr time. otherwise moves to 
-       blocked or gets preempted
-    */
-
-    // returns 1 if it has finished running, 0 otherwise
-    for(int i = 0; i < numProcs; i++) {
-        //check if in blocked state
-        if(processes[i].state == 1 && !(processes[i].justBlocked)) {
-            totCPU += 1;
-            processes[i].runningTimer -= 1;
-            processes[i].CPUleft -= 1;
-            processes[i].Qtimer -= 1;
-
-            //if this causes their timer to end,
-            //check if need to move to blocked state with new blockedTimer
-            //or to finished state
-            if(processes[i].CPUleft == 0) { //terminated
-                processes[i].state = 3;
-                processes[i].finishTime = currTime;
-                finalFinish = currTime;
-            }
-            else if(processes[i].runningTimer == 0) { //block
-                processes[i].state = 2;
-                processes[i].blockedTimer = randomOS(randomNums, processes[i].IO, processes[i].IO);
-            }
 
-            else if(Q == 2 && processes[i].Qtimer == 0) {
-                temp[c] = processes[i].pid;
-                c++;
+        /* a line adding up past 64 bits stays at LLONG_MAX, which
+           maxRuntime then can't fit either */
+        long long total = 0;
+        long long v;
+        const char *c = line;
+        while((v = parseTraceValue(&c, nl)) >= 0) {
+            if(__builtin_add_overflow(total, v, &total)) {
+                total = LLONG_MAX;
             }
         }
-        else if(processes[i].justBlocked == 1) {
-            processes[i].justBlocked = 0;
-        }
-    }
-    return c;
-}
-
-int somethingRunning(process processes[]) {
-
-	//printf("***** CHECKING IF SOMETHING IS RUNNING NOW!*****\n");
-    //return 1 if something is running, otherwise 0
-    for(int i = 0; i < numProcs; i++) {
-        if(processes[i].state == 1) return 1;
-    }
-    return 0;
-}
 
-void moveProcToRunning(process processes[], int *q, int currTime) {
-    //need to move first process off queue to running state
-    //calculate how long it's been in Q this time and add to
-    //total running wait time in Q
-    int p = dequeue(q);
-    processes[p].state = 1;
-    if(processes[p].runningTimer == 0) {
-        processes[p].runningTimer = randomOS(randomNums, processes[p].B, processes[p].CPUleft);
-    }
-    //processes[p].runningTimer = randomOS(randomNums, processes[p].B, processes[p].CPUleft);
-    //printf("difference is: %d\n", (currTime - processes[p].timeIntoRQ) );
-    processes[p].waitTime += (currTime - processes[p].timeIntoRQ);
-    if(Q == 2) {
-        processes[p].Qtimer = 2;
+        trace->start[trace->lines] = line;
+        trace->end[trace->lines] = nl;
+        trace->total[trace->lines] = total;
+        trace->lines++;
+        line = nl + 1;
     }
+    return trace;
 }
 
-int updateBlocked(process processes[], int *temp, int c) {
-
-    //add processes that have finished blocking to temp array
-    int flag = 0;
-    for(int i = 0; i < numProcs; i++) {
-        //check if in blocked state
-        if(processes[i].state == 2) {
-            flag = 1;
-            processes[i].blockedTimer -= 1;
-            processes[i].IOtime += 1;
-            //if this causes their timer to end add to temp array
-            if(processes[i].blockedTimer == 0) {
-                //processes[i].state = 0;
-                temp[c] = processes[i].pid;
-                c++;
-                processes[i].justBlocked = 1;
+long long parseTraceValue(const char **cursor, const char *end) {
 
-            }
-        } 
+    /* reads the next burst off a line of the trace and moves
+       *cursor past it. -1 once the line is used up. anything that
+       isn't a whole number ends the program, and so does one past
+       INT_MAX since bursts end up in int timers */
+    const char *c = *cursor;
+    while(c < end && isTraceSeparator(*c)) {
+        c++;
     }
-    if (flag) { totIO += 1; }
-    return c;
-}
-
-void tieBreak(int *temp, int n, process processes[]) {
-
-    //use insertion sort twice to sort the elements in 
-    //the temp array to be placed in the readyQ. first 
-    //sort by arrival time and then by pid. since insertion
-    //sort is stable, this will correctly break all ties
-    //n is number of elements in temp array
-
-    int c,d,t;
-
-    for (c = 1 ; c <= n - 1; c++) {
-        d = c;
-     
-        while ( d > 0 && processes[temp[d]].A < processes[temp[d-1]].A) {
-          t = temp[d];
-          temp[d] = temp[d-1];
-          temp[d-1] = t;
-          d--;
-        }
+    *cursor = c;
+    if(c == end) {
+        return -1;
     }
 
-    for (c = 1 ; c <= n - 1; c++) {
-        d = c;
-     
-        while ( d > 0 && processes[temp[d]].pid < processes[temp[d-1]].pid) {
-          t = temp[d];
-          temp[d] = temp[d-1];
-          temp[d-1] = t;
-          d--;
-        }
-    } 
-}
-
-void sortQSJF(int *temp, int n, process processes[]) {
-    int c,d,t;
-
-    for (c = 1 ; c <= n - 1; c++) {
-        d = c;
-     
-        while ( d > 0 && processes[temp[d]].CPUleft < processes[temp[d-1]].CPUleft) {
-          t = temp[d];
-          temp[d] = temp[d-1];
-          temp[d-1] = t;
-          d--;
-        }
-    } 
-}
-
-int QSize(int *q) {
-    int n = 0;
-    for(int i = 0; i < numProcs; i++) {
-        if(q[i] != -1) {
-            n++;
-        }
+    const char *t = c;
+    while(t < end && !isTraceSeparator(*t)) {
+        t++;
     }
-    return n;
-}
 
-int allDone(process processes[]) {
-    //return 0 when at least one process not finished, 1 otherwise
-    for(int i = 0; i < numProcs; i++) {
-        if(processes[i].state != 3) {
-            return 0;
+    long long v = 0;
+    for(; c < t; c++) {
+        if(*c < '0' || *c > '9') {
+            printf("Trace has '%.*s' where a burst length should be. Exiting.\n", (int)(t - *cursor), *cursor);
+            exit(1);
+        }
+        v = v * 10 + (*c - '0');
+        if(v > INT_MAX) {
+            printf("Trace burst %.*s is out of range, bursts can be at most %d cycles. Exiting.\n",
+                (int)(t - *cursor), *cursor, INT_MAX);
+            exit(1);
         }
     }
-    return 1;
+    *cursor = c;
+    return v;
 }
 
-void zeroArr(int *arr) {
-    for(int i = 0; i < numProcs; i++) {
-        arr[i] = -1;
-    }
+int isTraceSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
 }
 
-void readFile(FILE *file, process processes[]) {
-    
-    char paren1;
-    int a;
-    int b;
-    int c;
-    int io;
-    char paren2;
-
-    for(int i = 0; i < numProcs; i++) {
-        fscanf(file, " %c %d %d %d %d %c", &paren1, &a, &b, &c, &io, &paren2);
-        process newP = createProcess(a,b,c,io,i);
-        processes[i] = newP;
+long long parseCycle(const char *str, char **end) {
+    //reads a cycle number, -1 if it's negative or doesn't fit in 64 bits
+    errno = 0;
+    long long v = strtoll(str, end, 10);
+    if(*end == str || errno == ERANGE || v < 0) {
+        return -1;
     }
+    return v;
 }
 
-int randomOS(FILE *file, int U, int CPUleft) {
+int parseVariant(const char *tok, char *scheduler, int *q) {
 
-    /* gets reference to file, grabs next number, 
-        mods it with burst time and adds 1.
-        if it's greater than cpu left returns cpu left */
-	int r;
-
-    fscanf(file,"%d",&r);
-   
-    r = 1 + (r % U);
-
-    if (r < CPUleft) {
-    	return r;
+    /* reads one entry of the --fork list, f, s or r optionally
+       followed by a quantum for r. returns -1 if it isn't one */
+    *scheduler = tok[0];
+    *q = quantum;
+    if(tok[0] == '\0' || strchr("fsr", tok[0]) == NULL) {
+        return -1;
     }
-    else {
-    	return CPUleft;
+    if(tok[1] == '\0') {
+        return 0;
     }
-} 
-
-
-
-/* ============= INDIVIDUAL SCHEDULERS ================ */
-
-void FCFS(process processes[], int *readyQ, int *temp) {
-
-    /* 
-        FCFS algorithm. Initializes states before entering while loop.
-        Continues so long as some processes still running. Not preemptive.
-        global vars keep track of system usage. 
-    */
-    int currTime = 0;
-    int c = 0;
-
-    if(verbose) {
-        printState(processes, currTime);
+    if(tok[0] != 'r') {
+        return -1;
     }
-
-    c = newPtoTemp(processes, currTime, temp);
-    tempToReady(temp, readyQ, c, currTime, processes);
-
-
-    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-        moveProcToRunning(processes, readyQ, currTime);
+    char *end;
+    errno = 0;
+    long v = strtol(tok + 1, &end, 10);
+    if(end == tok + 1 || *end != '\0' || errno == ERANGE || v <= 0 || v > INT_MAX) {
+        return -1;
     }
+    *q = (int) v;
+    return 0;
+}
 
-    currTime++;
-    c = 0;
-    zeroArr(temp);
-
-
-    //printState(processes, currTime);
-    while(!allDone(processes)) {
-
-        if(verbose) {
-            printState(processes, currTime);
-        }  
-
-        //put all newly created processes in temp array
-        c = newPtoTemp(processes, currTime, temp);
-
-        //update all blocked and put newly unblocked processes in temp array
-        c = updateBlocked(processes, temp, c);
-
-        //put all processes from temp array onto readyQ
-        tempToReady(temp, readyQ, c, currTime, processes);
-
-        updateRun(processes, currTime, temp, c);
-
-        //if nothing is running and our queue isn't empty, 
-        //put first proc from readyQ in running position
-        if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-            moveProcToRunning(processes, readyQ, currTime);
-        }
+int runBatch(char *args[], int n, const char *format) {
 
-        currTime++;
-        zeroArr(temp);
-        c = 0;
+    /* args holds any number of input files followed by the random
+       numbers file and the scheduler. the random numbers are read
+       once for all of them. returns the number of inputs skipped */
+    char scheduler = *args[n-1];
+    int csv = (strcmp(format, "csv") == 0);
 
+    if(strchr("fsur", scheduler) == NULL) {
+        printf("Not a valid scheduler. Exiting.\n");
+        exit(1);
     }
-}
 
-void uniprogrammed(process processes[], int *readyQ, int *temp) {
-    int currTime = 0;
-    int c = 0;
-
-    if(verbose) {
-        printState(processes, currTime);
-    }    
-
-    /* put all processes on readyQ in their correct order */
-    for(int i = 0; i < numProcs; i++) {
-        if(processes[i].A == 0) {
-            enqueue(readyQ, processes[i].pid); 
-            processes[i].state = 0;
-            processes[i].timeIntoRQ = 0;
-            //printf("processes[%d].timeIntoRQ = %d\n", i, processes[i].timeIntoRQ);
-        }
+    FILE *randomFile = fopen(args[n-2], "r");
+    if(randomFile == 0) {
+        printf( "Could not open file\n" );
+        exit(1);
     }
+    readRandomNums(randomFile);
+    fclose(randomFile);
 
-    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-        moveProcToRunning(processes, readyQ, currTime);
+    if(csv) {
+        printf("record,file,scheduler,process,processes,A,B,C,IO,finish,turnaround,io_time,wait,"
+            "cpu_utilization,io_utilization,throughput,avg_turnaround,avg_wait\n");
     }
 
-    currTime++;
-    c = 0;
-    zeroArr(temp);
-
-    int currProc = 0;
-
-    while (currProc < numProcs) {
-        processes[currProc].state = 1;
-        processes[currProc].waitTime += (currTime - processes[currProc].timeIntoRQ - 1);
-        processes[currProc].runningTimer = randomOS(randomNums, processes[currProc].B, processes[currProc].CPUleft);
-        while(processes[currProc].state != 3) {
-
-            if(verbose) {
-                printState(processes, currTime);
-            }
-
-            c = updateBlocked(processes, temp, c);
-            if(c > 0) {
-                //if it got unblocked, put it in my temporary RQ
-                processes[currProc].state = 0;
-            }
-            updateRun(processes, currTime, temp, c);
-
-            if(processes[currProc].state == 0) {
-                processes[currProc].state = 1;
-                processes[currProc].runningTimer = randomOS(randomNums, processes[currProc].B, processes[currProc].CPUleft);
-
-            }
-
-            currTime++;
-            c = 0;
-
-            for(int i = 0; i < numProcs; i++) {
-                if(processes[i].A == currTime) {
-                    enqueue(readyQ, processes[i].pid); 
-                    processes[i].state = 0;
-                    processes[i].timeIntoRQ = currTime;
-                }
-            }
-
+    /* each input picks its own clock width, like a single run */
+    int skipped = 0;
+    for(int f = 0; f < n - 2; f++) {
+        int status = batchFile32(args[f], scheduler, csv);
+        if(status == NEEDS_WIDE) {
+            status = batchFile64(args[f], scheduler, csv);
         }
-        currProc++;
-
-    }
-}
-
-void RR( process processes[], int *readyQ, int *temp ) {
-
-    //set Q to quantum
-    Q = 2;
-
-    /* initialization steps */
-    int currTime = 0;
-    int c = 0;
-
-    if(verbose) {
-        printState(processes, currTime);
-    }   
-    c = newPtoTemp(processes, currTime, temp);
-    tempToReady(temp, readyQ, c, currTime, processes);
-
-
-    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-        moveProcToRunning(processes, readyQ, currTime);
-    }
-
-    currTime++;
-    c = 0;
-    zeroArr(temp);
-
-
-    //printState(processes, currTime);
-    while(!allDone(processes)) {
-
-        if(verbose) {
-            printState(processes, currTime);
+        if(status == -1) {
+            fprintf(stderr, "Skipping %s: could not read processes\n", args[f]);
+            skipped++;
         }
-
-        //put all newly created processes in temp array
-        c = newPtoTemp(processes, currTime, temp);
-
-        //update all blocked and put newly unblocked processes in temp array
-        c = updateBlocked(processes, temp, c);
-
-        c = updateRun(processes, currTime, temp, c);
-
-        //put all processes from temp array onto readyQ
-        tempToReady(temp, readyQ, c, currTime, processes);
-
-
-        //if nothing is running and our queue isn't empty, 
-        //put first proc from readyQ in running position
-        if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-            moveProcToRunning(processes, readyQ, currTime);
+        else if(status == NEEDS_WIDE) {
+            fprintf(stderr, "Skipping %s: can run for more cycles than a 64 bit clock can count\n", args[f]);
+            skipped++;
         }
-
-        currTime++;
-        zeroArr(temp);
-        c = 0;
     }
-}
-
-void SJF(process processes[], int *readyQ, int *temp) {
-    int currTime = 0;
-    int c = 0;
-    int n = 0;
 
-    if(verbose) {
-        printState(processes, currTime);
-    }    
-    c = newPtoTemp(processes, currTime, temp);
-    tempToReady(temp, readyQ, c, currTime, processes);
-
-    n = QSize(readyQ);
-    sortQSJF(readyQ, n, processes);
-
-
-    if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-        moveProcToRunning(processes, readyQ, currTime);
-    }
-
-    currTime++;
-    c = 0;
-    zeroArr(temp);
-
-
-    //printState(processes, currTime);
-    while(!allDone(processes)) {
-
-        if(verbose) {
-            printState(processes, currTime);
-        }
-
-        //put all newly created processes in temp array
-        c = newPtoTemp(processes, currTime, temp);
-
-        //update all blocked and put newly unblocked processes in temp array
-        c = updateBlocked(processes, temp, c);
-
-        //put all processes from temp array onto readyQ
-        tempToReady(temp, readyQ, c, currTime, processes);
-
-        n = QSize(readyQ);
-        sortQSJF(readyQ, n, processes);
-
-        updateRun(processes, currTime, temp, c);
-
-        //if nothing is running and our queue isn't empty, 
-        //put first proc from readyQ in running position
-        if(!somethingRunning(processes) && !qIsEmpty(readyQ)) {
-            moveProcToRunning(processes, readyQ, currTime);
-        }
-
-        currTime++;
-        zeroArr(temp);
-        c = 0;
-
-    }
+    freeBatch32();
+    freeBatch64();
+    return skipped;
 }
-
-
-
-
-